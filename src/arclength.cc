@@ -0,0 +1,96 @@
+#include "arclength.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace nealrame;
+
+const unsigned int ArcLength::DefaultSamples;
+
+ArcLength::ArcLength(const Bezier &curve, unsigned int samples) :
+	curve_(curve),
+	samples_(std::max(samples, 1u))
+{ }
+
+const Bezier & ArcLength::curve() const
+{
+	return curve_;
+}
+
+void ArcLength::build() const
+{
+	if (! table_.empty()) return;
+
+	table_.resize(samples_ + 1);
+	table_[0] = 0;
+	for (unsigned int i = 1; i <= samples_; ++i) {
+		table_[i] = table_[i - 1] + curve_.length(real(i - 1)/samples_, real(i)/samples_);
+	}
+}
+
+real ArcLength::length() const
+{
+	build();
+	return table_.back();
+}
+
+real ArcLength::length(real t) const
+{
+	build();
+
+	t = std::min(std::max(t, real(0)), real(1));
+
+	auto i = std::min(unsigned(t*samples_), samples_ - 1);
+	return table_[i] + curve_.length(real(i)/samples_, t);
+}
+
+/// La longueur etant croissante en t, la methode de Newton est gardee
+/// dans l'intervalle [lo, hi] qui encadre la solution: une iteration qui en
+/// sortirait est remplacee par une bissection. L'ecart a s est mis a jour
+/// par la longueur du seul pas effectue.
+real ArcLength::parameter(real s) const
+{
+	build();
+
+	auto total = table_.back();
+	if (total <= 0) return 0;
+
+	s = std::min(std::max(s, real(0)), total);
+
+	auto i = unsigned(std::upper_bound(table_.begin() + 1, table_.end() - 1, s) - table_.begin() - 1);
+	auto lo = real(i)/samples_, hi = real(i + 1)/samples_;
+	auto span = table_[i + 1] - table_[i];
+	auto t = span > 0 ? lo + (s - table_[i])/span*(hi - lo) : lo;
+	auto error = table_[i] + curve_.length(lo, t) - s;
+	auto tolerance = 1e-5f*total;
+
+	for (unsigned int k = 0; k < 16 && std::fabs(error) > tolerance; ++k) {
+		if (error > 0) {
+			hi = t;
+		} else {
+			lo = t;
+		}
+
+		auto speed = curve_.speed(t);
+		auto next = speed > 0 ? t - error/speed : lo;
+		if (! (next > lo && next < hi)) {
+			next = (lo + hi)/2;
+		}
+
+		error += curve_.length(t, next);
+		t = next;
+	}
+	return t;
+}
+
+void ArcLength::parameters(const real *ss, std::size_t count, real *ts) const
+{
+	for (std::size_t i = 0; i < count; ++i) {
+		ts[i] = parameter(ss[i]);
+	}
+}
+
+Point ArcLength::point(real s) const
+{
+	return curve_(parameter(s));
+}
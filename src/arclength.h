@@ -0,0 +1,57 @@
+#pragma once
+
+#include "bezier.h"
+#include "common.h"
+#include "point.h"
+
+#include <vector>
+
+namespace nealrame
+{
+/// Parametrisation d'une courbe par l'abscisse curviligne.
+///
+/// A la premiere requete, la longueur de l'arc est calculee (voir
+/// Bezier::length()) pour samples + 1 valeurs de t regulierement
+/// espacees, et conservee dans une table. La longueur en t s'obtient
+/// ensuite en completant la valeur de la table par une quadrature sur un
+/// seul intervalle, et le parametre associe a une longueur s par une
+/// recherche dichotomique dans la table, en O(log(samples)), suivie de
+/// quelques iterations de Newton dans l'intervalle trouve.
+///
+/// La table est construite paresseusement par des methodes const: une
+/// instance ne doit pas etre partagee entre threads avant sa construction
+/// (voir build()).
+class ArcLength {
+public:
+	static const unsigned int DefaultSamples = 32;
+
+public:
+	ArcLength(const Bezier &, unsigned int samples = DefaultSamples);
+
+	const Bezier & curve() const;
+
+	/// Construit la table si ce n'est deja fait.
+	void build() const;
+
+	/// Longueur totale de la courbe.
+	real length() const;
+
+	/// Longueur de l'arc entre les parametres 0 et t.
+	real length(real t) const;
+
+	/// Parametre du point situe a la distance s (ramenee a [0, length()])
+	/// du debut de la courbe.
+	real parameter(real s) const;
+
+	/// Calcule le parametre de chacune des count distances de ss.
+	void parameters(const real *ss, std::size_t count, real *ts) const;
+
+	/// Point situe a la distance s du debut de la courbe.
+	Point point(real s) const;
+
+private:
+	Bezier curve_;
+	unsigned int samples_;
+	mutable std::vector<real> table_;
+};
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "common.h"
+#include "flatten.h"
+#include "path.h"
+#include "point.h"
+
+#include <vector>
+
+namespace nealrame
+{
+struct Color;
+class EdgeList;
+class Rect;
+
+/// Interface des implementations de dessin utilisees par Painter. Les
+/// courbes et les chemins sont tessellees par Painter: une implementation
+/// ne recoit que des lignes brisees.
+class Backend {
+public:
+	virtual ~Backend()
+	{ }
+
+	virtual bool clear() = 0;
+	virtual bool setDrawColor(const Color &) = 0;
+
+	/// Fixe l'epaisseur, en pixels, des traits suivants.
+	virtual bool setLineWidth(real width) = 0;
+
+	/// Trace la ligne brisee decalee de offset.
+	virtual bool drawPolyline(const Polyline &, const Point &offset) = 0;
+
+	virtual bool drawRect(const Rect &) = 0;
+
+	/// Remplit la zone delimitee par les contours fermes donnes.
+	virtual bool fill(const std::vector<Polyline> &contours, FillRule) = 0;
+
+	/// Remplit la zone delimitee par les segments orientes de la liste
+	/// (voir Stroker).
+	virtual bool fill(const EdgeList &, FillRule) = 0;
+
+	virtual void present() = 0;
+};
+}
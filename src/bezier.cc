@@ -1,47 +1,23 @@
 #include "bezier.h"
 
+#include <type_traits>
+
 using namespace nealrame;
 
+static_assert(std::is_trivially_copyable<Bezier>::value, "Bezier must stay trivially copyable");
+static_assert(sizeof(Bezier) == 4*sizeof(Point), "Bezier must only hold its control points");
+
 /// Calcule les extremums locaux sur l'interval [0, 1] du polynome p de
-/// derivee d.
-void
+/// derivee d, aux racines de d(x) = 0 dans [0, 1].
+static void
 extremum(real &min, real &max, const Bezier::Polynomial::Derived &d, const Bezier::Polynomial &p)
 {
-	/// On cherche les solution de l'equation d(x) = 0.
-	/// On ne considere que les valeurs appartenant a l'intervalle [0, 1].
-	switch (d.degree())
-	{
-	case 2: {
-		auto discriminant = SQUARE(d[1]) - 4*d[2]*d[0];
-		if (discriminant >= 0) {
-			auto sqrt_of_discriminant = std::sqrt(discriminant);
-
-			auto r1 = (-d[1] - sqrt_of_discriminant)/(2*d[2]);
-			if (r1 >= 0 && r1 <= 1) {
-				auto v = p(r1);
-				min = std::min(v, min);
-				max = std::max(v, max);
-			}
-
-			auto r2 = (-d[1] + sqrt_of_discriminant)/(2*d[2]);
-			if (r2 >= 0 && r2 <= 1) {
-				auto v = p(r2);
-				min = std::min(v, min);
-				max = std::max(v, max);
-			}
-		}
-	} break;
-
-	case 1: {
-		auto r = -(d[0]/d[1]);
-		if (r >= 0 && r <= 1) {
-			auto v = p(r);
-			min = std::min(v, min);
-			max = std::max(v, max);
-		}
-	} break;
+	real roots[2];
 
-	default: break;
+	for (unsigned int i = 0, count = d.roots(0, 1, roots); i < count; ++i) {
+		auto v = p(roots[i]);
+		min = std::min(v, min);
+		max = std::max(v, max);
 	}
 }
 
@@ -62,6 +38,26 @@ Bezier Bezier::fromBoundingBox(const Rect &box, real ratio) {
 }
 
 
+void Bezier::extent(const Polynomial &p, real &min, real &max)
+{
+	min = std::min(p(0), p(1));
+	max = std::max(p(0), p(1));
+
+	extremum(min, max, p.derived(), p);
+}
+
+void Bezier::extent(real p0, real p1, real p2, real p3, real &min, real &max)
+{
+	min = std::min(p0, p3);
+	max = std::max(p0, p3);
+
+	if (std::min(p1, p2) < min || std::max(p1, p2) > max) {
+		const real values[] = {p0, p1, p2, p3};
+		extent(BezierN<3>::component(values), min, max);
+	}
+}
+
+
 /// Une courbe de bezier est une fonction parametrique définie sur [0,1]
 /// comme telle:
 ///     [0, 1] -> ℝ×ℝ
@@ -69,50 +65,205 @@ Bezier Bezier::fromBoundingBox(const Rect &box, real ratio) {
 ///     x(t) = P0.x*(1-t)³ + 3*P1.x*(1-t)²t + 3*P2.x(1-t)t² + 3*P3.x*t³
 ///     y(t) = P0.y*(1-t)³ + 3*P1.y*(1-t)²t + 3*P2.y(1-t)t² + 3*P3.y*t³
 ///
-/// Nous utiliserons la forme developpee des polynomes.
+/// Nous utiliserons la forme developpee des polynomes, dont les
+/// coefficients sont donnes par BezierN<3>. Ils sont calcules a la demande
+/// (voir xPolynomial()): seuls les points de controle sont conserves.
 ///
 /// Pour plus d'infos consulter:
 ///   http://pomax.github.io/bezierinfo
 ///   http://floris.briolas.nl/floris/2009/10/bounding-box-of-cubic-bezier
 Bezier::Bezier(const Point &p0, const Point &p1, const Point &p2, const Point &p3) :
 	p1_(p0), p2_(p3), c1_(p1), c2_(p2)
-{
-	// Initialize les coefficients du polynome pour la composante x
-	x[0] = 1*p0.x;
-	x[1] = 3*p1.x - 3*p0.x;
-	x[2] = 3*p2.x - 6*p1.x + 3*p0.x;
-	x[3] = 1*p3.x - 3*p2.x + 3*p1.x - p0.x;
+{ }
 
-	// Initialize les coefficients du polynome pour la composante y
-	y[0] = 1*p0.y;
-	y[1] = 3*p1.y - 3*p0.y;
-	y[2] = 3*p2.y - 6*p1.y + 3*p0.y;
-	y[3] = 1*p3.y - 3*p2.y + 3*p1.y - p0.y;
+Bezier::Bezier(const BezierN<3> &curve) :
+	Bezier(curve[0], curve[1], curve[2], curve[3])
+{ }
 
-	dx = x.derived();
-	dy = y.derived();
+Bezier::Polynomial Bezier::xPolynomial() const
+{
+	const real xs[] = {p1_.x, c1_.x, c2_.x, p2_.x};
+	return BezierN<3>::component(xs);
+}
+
+Bezier::Polynomial Bezier::yPolynomial() const
+{
+	const real ys[] = {p1_.y, c1_.y, c2_.y, p2_.y};
+	return BezierN<3>::component(ys);
 }
 
-/// Evalue la courbe pour la valeur donnee
+/// Evalue la courbe pour la valeur donnee, directement dans la base de
+/// Bernstein: les quatre poids sont communs aux deux composantes.
 Point Bezier::operator()(real t) const
 {
-	return {x(t), y(t)};
+	auto s = 1 - t;
+	auto b0 = s*s*s, b1 = 3*s*s*t, b2 = 3*s*t*t, b3 = t*t*t;
+
+	return {
+		b0*p1_.x + b1*c1_.x + b2*c2_.x + b3*p2_.x,
+		b0*p1_.y + b1*c1_.y + b2*c2_.y + b3*p2_.y
+	};
+}
+
+void Bezier::evaluate(const real *ts, std::size_t count, real *xs, real *ys) const
+{
+	xPolynomial().evaluate(ts, count, xs);
+	yPolynomial().evaluate(ts, count, ys);
+}
+
+void Bezier::evaluate(
+	const Bezier *curves, std::size_t curveCount,
+	const real *ts, std::size_t count, real *xs, real *ys)
+{
+	for (std::size_t i = 0; i < curveCount; ++i) {
+		curves[i].evaluate(ts, count, xs + i*count, ys + i*count);
+	}
 }
 
 /// Calcul et retourne la bouding box de la courbe.
 Rect Bezier::boudingBox() const
 {
-	auto min_x = std::min(x(0), x(1));
-	auto max_x = std::max(x(0), x(1));
-	auto min_y = std::min(y(0), y(1));
-	auto max_y = std::max(y(0), y(1));
+	real min_x, max_x, min_y, max_y;
 
-	extremum(min_x, max_x, dx, x);
-	extremum(min_y, max_y, dy, y);
+	extent(p1_.x, c1_.x, c2_.x, p2_.x, min_x, max_x);
+	extent(p1_.y, c1_.y, c2_.y, p2_.y, min_y, max_y);
 
 	return Rect({min_x, min_y}, {max_x, max_y});
 }
 
+Rect Bezier::controlBox() const
+{
+	return Rect(
+		{
+			std::min(std::min(p1_.x, c1_.x), std::min(c2_.x, p2_.x)),
+			std::min(std::min(p1_.y, c1_.y), std::min(c2_.y, p2_.y))
+		},
+		{
+			std::max(std::max(p1_.x, c1_.x), std::max(c2_.x, p2_.x)),
+			std::max(std::max(p1_.y, c1_.y), std::max(c2_.y, p2_.y))
+		}
+	);
+}
+
+/// La derivee est la quadratique de points de controle 3*(c1 - p1),
+/// 3*(c2 - c1) et 3*(p2 - c2) (voir BezierN::derived()).
+Point Bezier::derivative(real t) const
+{
+	auto s = 1 - t;
+	auto b0 = 3*s*s, b1 = 6*s*t, b2 = 3*t*t;
+
+	return b0*(c1_ - p1_) + b1*(c2_ - c1_) + b2*(p2_ - c2_);
+}
+
+real Bezier::speed(real t) const
+{
+	auto d = derivative(t);
+	return std::sqrt(SQUARE(d.x) + SQUARE(d.y));
+}
+
+/// Quadrature de Gauss-Legendre a 8 points de la vitesse sur [t0, t1]:
+/// exacte pour les polynomes de degre 15, elle ne laisse qu'une erreur
+/// negligeable tant que la vitesse ne s'annule pas dans l'intervalle.
+static real gaussLegendre(const Bezier &c, real t0, real t1)
+{
+	static const real nodes[] = {
+		0.1834346424956498f, 0.5255324099163290f,
+		0.7966664774136267f, 0.9602898564975363f
+	};
+	static const real weights[] = {
+		0.3626837833783620f, 0.3137066458778873f,
+		0.2223810344533745f, 0.1012285362903763f
+	};
+
+	auto half = (t1 - t0)/2, middle = (t0 + t1)/2;
+	real sum = 0;
+
+	for (unsigned int i = 0; i < 4; ++i) {
+		sum += weights[i]*(c.speed(middle - half*nodes[i]) + c.speed(middle + half*nodes[i]));
+	}
+	return sum*half;
+}
+
+/// Pres d'un point de rebroussement, la vitesse n'est plus polynomiale:
+/// l'intervalle est coupe en deux tant que la quadrature ne s'accorde pas
+/// avec celle des deux moities.
+static real adaptiveLength(const Bezier &c, real t0, real t1, real whole, unsigned int depth)
+{
+	auto middle = (t0 + t1)/2;
+	auto left = gaussLegendre(c, t0, middle);
+	auto right = gaussLegendre(c, middle, t1);
+
+	if (depth == 0 || std::fabs(left + right - whole) <= 1e-5f*(left + right) + 1e-6f) {
+		return left + right;
+	}
+	return adaptiveLength(c, t0, middle, left, depth - 1)
+		+ adaptiveLength(c, middle, t1, right, depth - 1);
+}
+
+real Bezier::length(real t0, real t1) const
+{
+	if (t0 == t1) return 0;
+	if (t1 < t0) return -length(t1, t0);
+
+	return adaptiveLength(*this, t0, t1, gaussLegendre(*this, t0, t1), 8);
+}
+
+Bezier::Projection Bezier::project(const Point &p) const
+{
+	auto ex = xPolynomial(), ey = yPolynomial();
+	auto dx = ex.derived(), dy = ey.derived();
+	ex[0] -= p.x;
+	ey[0] -= p.y;
+
+	real ts[5];
+	auto count = (ex*dx + ey*dy).roots(0, 1, ts);
+
+	Projection best = {0, p1_, std::numeric_limits<real>::infinity()};
+	auto consider = [&](real t, const Point &q) {
+		auto d = SQUARE(q.x - p.x) + SQUARE(q.y - p.y);
+		if (d < best.distance) {
+			best = {t, q, d};
+		}
+	};
+
+	consider(0, p1_);
+	consider(1, p2_);
+	for (unsigned int i = 0; i < count; ++i) {
+		consider(ts[i], (*this)(ts[i]));
+	}
+
+	best.distance = std::sqrt(best.distance);
+	return best;
+}
+
+Bezier::Stepper Bezier::stepper(unsigned int steps) const
+{
+	return Stepper(xPolynomial(), yPolynomial(), steps);
+}
+
+/// Pour p(t) = a0 + a1*t + a2*t² + a3*t³, les differences successives en t
+/// avec un pas h valent:
+///     d1(t) = p(t + h) - p(t)
+///     d2(t) = d1(t + h) - d1(t)
+///     d3    = 6*a3*h³ (constante)
+static void forwardDifferences(real f[4], const Bezier::Polynomial &p, real h)
+{
+	auto h2 = h*h, h3 = h2*h;
+
+	f[0] = p[0];
+	f[1] = p[1]*h + p[2]*h2 + p[3]*h3;
+	f[2] = 2*p[2]*h2 + 6*p[3]*h3;
+	f[3] = 6*p[3]*h3;
+}
+
+Bezier::Stepper::Stepper(const Polynomial &x, const Polynomial &y, unsigned int steps)
+{
+	auto h = steps > 0 ? real(1)/steps : 0;
+
+	forwardDifferences(fx_, x, h);
+	forwardDifferences(fy_, y, h);
+}
+
 Point Bezier::p1() const 
 { return p1_; }
 
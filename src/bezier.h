@@ -1,5 +1,6 @@
 #pragma once
 
+#include "beziern.h"
 #include "common.h"
 #include "point.h"
 #include "polynomial.h"
@@ -10,30 +11,172 @@ namespace nealrame
 class Bezier {
 public:
 	typedef Polynomial<3> Polynomial;
+	class Stepper;
+
+	/// Point de la courbe le plus proche d'un point donne: parametre,
+	/// point et distance (voir project()).
+	struct Projection {
+		real t;
+		Point point;
+		real distance;
+	};
 
 public:
 	static Bezier fromBoundingBox(const Rect &, real ratio = 1/8);
 
+	/// Calcule les valeurs extremes prises sur [0, 1] par le polynome
+	/// d'une composante de la courbe.
+	static void extent(const Polynomial &, real &min, real &max);
+
+	/// Calcule les valeurs extremes prises sur [0, 1] par la composante
+	/// de valeurs p0, p1, p2 et p3 aux points de controle. Lorsque les
+	/// valeurs aux controles sont comprises entre celles aux extremites,
+	/// cas le plus courant, la composante est monotone par morceaux entre
+	/// ses extremites et aucune racine n'est calculee.
+	static void extent(real p0, real p1, real p2, real p3, real &min, real &max);
+
 public:
 	Bezier()
 	{ }
 
 	Bezier(const Point &, const Point &, const Point &, const Point &);
 
+	/// Une quadratique BezierN<2> q s'ajoute par Bezier(q.elevated()).
+	explicit Bezier(const BezierN<3> &);
+
 	/// Evalue la courbe pour la valeur donnee
 	Point operator()(real) const;
 
+	/// Evalue la courbe pour chacune des count valeurs de ts. Les abscisses
+	/// et ordonnees des points obtenus sont ecrites dans xs et ys.
+	void evaluate(const real *ts, std::size_t count, real *xs, real *ys) const;
+
+	/// Evalue chacune des curveCount courbes pour chacune des count valeurs
+	/// de ts. Les resultats sont ranges courbe par courbe: le point de la
+	/// courbe i pour ts[j] est (xs[i*count + j], ys[i*count + j]).
+	static void evaluate(
+		const Bezier *curves, std::size_t curveCount,
+		const real *ts, std::size_t count, real *xs, real *ys);
+
 	/// Calcul et retourne la bouding box de la courbe.
 	Rect boudingBox() const;
 
+	/// Retourne la boite des points de controle. Elle contient la courbe
+	/// (enveloppe convexe) sans etre minimale, mais ne coute que des
+	/// comparaisons: elle suffit pour ecarter les courbes hors d'une zone.
+	Rect controlBox() const;
+
+	/// Retourne le vecteur derive en t.
+	Point derivative(real t) const;
+
+	/// Retourne la norme du vecteur derive en t.
+	real speed(real t) const;
+
+	/// Calcule la longueur de l'arc compris entre les parametres t0 et t1
+	/// (voir ArcLength pour des requetes repetees).
+	real length(real t0 = 0, real t1 = 1) const;
+
+	/// Retourne le point de la courbe le plus proche de p. La distance
+	/// est minimale aux extremites ou en un parametre t ou la courbe est
+	/// orthogonale a p - C(t), c'est-a-dire une racine dans [0, 1] de
+	///     (x(t) - p.x)*x'(t) + (y(t) - p.y)*y'(t)
+	/// polynome de degre 5 (voir Polynomial::roots()).
+	Projection project(const Point &p) const;
+
+	/// Coupe la courbe en t (algorithme de de Casteljau, sur les points de
+	/// controle) en ses portions [0, t] et [t, 1].
+	void split(real t, Bezier &left, Bezier &right) const;
+
+	/// Coupe la courbe aux count parametres croissants de ts et ecrit les
+	/// count + 1 portions obtenues, dans l'ordre, dans out.
+	void split(const real *ts, std::size_t count, Bezier *out) const;
+
+	/// Retourne la portion [t0, t1] de la courbe, reparametree sur [0, 1].
+	Bezier subcurve(real t0, real t1) const;
+
 	Point p1() const;
 	Point p2() const;
 	Point ctrl1() const;
 	Point ctrl2() const;
 
+	/// Calcule les polynomes des composantes de la courbe (voir
+	/// BezierN<3>::component()). Ils ne sont pas conserves: pour des
+	/// evaluations repetees, garder le resultat.
+	Polynomial xPolynomial() const;
+	Polynomial yPolynomial() const;
+
+	/// Retourne un parcours de la courbe en steps pas uniformes.
+	Stepper stepper(unsigned int steps) const;
+
 private:
-	Polynomial x,  y;
-	Polynomial::Derived dx, dy;
-	Point p1_, p2_, c1_, c2_; 
+	/// Seuls les points de controle sont conserves: une courbe qui n'est
+	/// que rangee, transformee ou decoupee ne coute ni le calcul ni la
+	/// place de ses coefficients.
+	Point p1_, p2_, c1_, c2_;
 };	
-}
\ No newline at end of file
+
+inline void Bezier::split(real t, Bezier &left, Bezier &right) const
+{
+	const Point p[] = {p1_, c1_, c2_, p2_};
+	Point l[4], r[4];
+
+	BezierN<3>::split(p, t, l, r);
+	left = Bezier(l[0], l[1], l[2], l[3]);
+	right = Bezier(r[0], r[1], r[2], r[3]);
+}
+
+/// Chaque portion est detachee du reste de la courbe, dont le parametre
+/// est ramene a [0, 1] a chaque coupe.
+inline void Bezier::split(const real *ts, std::size_t count, Bezier *out) const
+{
+	Point rest[] = {p1_, c1_, c2_, p2_}, piece[4];
+	real previous = 0;
+
+	for (std::size_t i = 0; i < count; ++i) {
+		auto t = previous < 1 ? (ts[i] - previous)/(1 - previous) : 1;
+		BezierN<3>::split(rest, t, piece, rest);
+		out[i] = Bezier(piece[0], piece[1], piece[2], piece[3]);
+		previous = ts[i];
+	}
+	out[count] = Bezier(rest[0], rest[1], rest[2], rest[3]);
+}
+
+inline Bezier Bezier::subcurve(real t0, real t1) const
+{
+	Point p[] = {p1_, c1_, c2_, p2_};
+
+	BezierN<3>::subcurve(p, t0, t1, p);
+	return Bezier(p[0], p[1], p[2], p[3]);
+}
+
+/// Parcourt la courbe par pas uniformes de h = 1/steps par la methode des
+/// differences finies: apres une initialisation a partir des coefficients
+/// des polynomes, chaque point est obtenu par trois additions par
+/// composante.
+///
+/// Precision: avec real = float (u = 2^-24), chaque addition introduit une
+/// erreur relative d'au plus u; ces erreurs se propagent d'une difference a
+/// l'autre et l'erreur sur le point obtenu apres n pas est bornee par
+/// environ 16*n*u*M, ou M est la plus grande coordonnee (en valeur absolue)
+/// des points de controle. Pour n <= 256 et M <= 4096 px, cela donne moins
+/// d'un pixel dans le pire cas et, en pratique, quelques centiemes de
+/// pixel. Pour obtenir une extremite exacte, utiliser Bezier::p2().
+class Bezier::Stepper {
+public:
+	Stepper(const Polynomial &x, const Polynomial &y, unsigned int steps);
+
+	/// Retourne le point courant.
+	Point point() const
+	{ return {fx_[0], fy_[0]}; }
+
+	/// Avance d'un pas.
+	void step()
+	{
+		fx_[0] += fx_[1]; fx_[1] += fx_[2]; fx_[2] += fx_[3];
+		fy_[0] += fy_[1]; fy_[1] += fy_[2]; fy_[2] += fy_[3];
+	}
+
+private:
+	real fx_[4], fy_[4];
+};
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "common.h"
+#include "point.h"
+#include "polynomial.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace nealrame
+{
+namespace bernstein
+{
+/// Coefficient binomial C(n, k), evalue a la compilation.
+constexpr real binomial(unsigned int n, unsigned int k)
+{
+	return k == 0 ? 1 : binomial(n, k - 1)*(n - k + 1)/k;
+}
+
+/// Terme de rang I du coefficient de degre J d'une courbe de degre N:
+///     a_J = C(N, J) * somme pour I <= J de (-1)^(J - I)*C(J, I)*p_I
+/// La somme est deroulee a la compilation; les facteurs sont constants.
+template <unsigned int N, unsigned int J, unsigned int I = 0>
+struct Coefficient {
+	static constexpr real Factor = binomial(N, J)*binomial(J, I)*((J - I) % 2 ? -1 : 1);
+
+	static real compute(const real *p)
+	{
+		return Factor*p[I] + Coefficient<N, J, I + 1>::compute(p);
+	}
+};
+
+template <unsigned int N, unsigned int J>
+struct Coefficient<N, J, J> {
+	static constexpr real Factor = binomial(N, J);
+
+	static real compute(const real *p)
+	{
+		return Factor*p[J];
+	}
+};
+
+/// Calcule les coefficients de degre J, J - 1, ..., 0.
+template <unsigned int N, unsigned int J = N>
+struct Coefficients {
+	static void compute(const real *p, real *factors)
+	{
+		factors[J] = Coefficient<N, J>::compute(p);
+		Coefficients<N, J - 1>::compute(p, factors);
+	}
+};
+
+template <unsigned int N>
+struct Coefficients<N, 0> {
+	static void compute(const real *p, real *factors)
+	{
+		factors[0] = p[0];
+	}
+};
+}
+
+/// Courbe de Bezier de degre N, decrite par ses N + 1 points de controle.
+///
+/// Le degre etant un parametre du patron, la conversion des points de
+/// controle en coefficients polynomiaux, l'evaluation et la derivation
+/// sont deroulees a la compilation pour chaque degre: une quadratique ne
+/// coute que ses trois points, sans appel virtuel ni elevation au degre 3.
+///
+/// Bezier reste la cubique utilisee par le reste du programme; ses
+/// coefficients sont calcules par BezierN<3>::component().
+template <unsigned int N>
+class BezierN {
+public:
+	typedef nealrame::Polynomial<N> Component;
+
+	static const unsigned int Degree = N;
+
+	/// Calcule le polynome d'une composante a partir de ses N + 1 valeurs
+	/// aux points de controle.
+	static Component component(const real (&values)[N + 1])
+	{
+		Component p;
+		bernstein::Coefficients<N>::compute(values, p.factors);
+		return p;
+	}
+
+	/// Coupe en t, par l'algorithme de de Casteljau, la courbe de points
+	/// de controle p: left recoit les points de la portion [0, t] et right
+	/// ceux de la portion [t, 1]. left ou right peut etre nul, ou egal a p.
+	static void split(const Point *p, real t, Point *left, Point *right)
+	{
+		Point q[N + 1], l[N + 1], r[N + 1];
+
+		std::copy(p, p + N + 1, q);
+		for (unsigned int k = 0; k <= N; ++k) {
+			l[k] = q[0];
+			r[N - k] = q[N - k];
+			for (unsigned int i = 0; i < N - k; ++i) {
+				q[i] = q[i] + (q[i + 1] - q[i])*t;
+			}
+		}
+		if (left) std::copy(l, l + N + 1, left);
+		if (right) std::copy(r, r + N + 1, right);
+	}
+
+	/// Ecrit dans out les points de controle de la portion [t0, t1] de la
+	/// courbe de points de controle p (out peut etre egal a p).
+	static void subcurve(const Point *p, real t0, real t1, Point *out)
+	{
+		split(p, t1, out, nullptr);
+		if (t0 > 0) {
+			split(out, t1 > 0 ? t0/t1 : 0, nullptr, out);
+		}
+	}
+
+public:
+	BezierN()
+	{ }
+
+	template <
+		typename... Points,
+		typename = typename std::enable_if<N != 0 && sizeof...(Points) == N + 1>::type
+	>
+	BezierN(const Points &... points) :
+		points_{Point(points)...}
+	{
+		update();
+	}
+
+	BezierN(const Point (&points)[N + 1])
+	{
+		std::copy(points, points + N + 1, points_);
+		update();
+	}
+
+	/// Evalue la courbe pour la valeur donnee
+	Point operator()(real t) const
+	{ return {x_(t), y_(t)}; }
+
+	/// Retourne le point de controle d'indice i (0 <= i <= N).
+	const Point & operator[](unsigned int i) const
+	{ return points_[i]; }
+
+	const Point * points() const
+	{ return points_; }
+
+	const Component & x() const
+	{ return x_; }
+
+	const Component & y() const
+	{ return y_; }
+
+	/// Retourne l'hodographe de la courbe, courbe de degre N - 1 de points
+	/// de controle N*(p[i + 1] - p[i]).
+	BezierN<N - 1> derived() const
+	{
+		static_assert(N > 0, "une courbe de degre 0 n'a pas d'hodographe");
+
+		Point points[N];
+		for (unsigned int i = 0; i < N; ++i) {
+			points[i] = real(N)*(points_[i + 1] - points_[i]);
+		}
+		return BezierN<N - 1>(points);
+	}
+
+	/// Coupe la courbe en t en ses portions [0, t] et [t, 1].
+	void split(real t, BezierN &left, BezierN &right) const
+	{
+		split(points_, t, left.points_, right.points_);
+		left.update();
+		right.update();
+	}
+
+	/// Retourne la portion [t0, t1] de la courbe, reparametree sur [0, 1].
+	BezierN subcurve(real t0, real t1) const
+	{
+		BezierN curve;
+		subcurve(points_, t0, t1, curve.points_);
+		curve.update();
+		return curve;
+	}
+
+	/// Retourne la meme courbe decrite au degre N + 1. Une quadratique
+	/// elevee ainsi est exactement la cubique equivalente.
+	BezierN<N + 1> elevated() const
+	{
+		Point points[N + 2];
+		points[0] = points_[0];
+		for (unsigned int i = 1; i <= N; ++i) {
+			auto k = real(i)/(N + 1);
+			points[i] = k*points_[i - 1] + (1 - k)*points_[i];
+		}
+		points[N + 1] = points_[N];
+		return BezierN<N + 1>(points);
+	}
+
+private:
+	void update()
+	{
+		real xs[N + 1], ys[N + 1];
+		for (unsigned int i = 0; i <= N; ++i) {
+			xs[i] = points_[i].x;
+			ys[i] = points_[i].y;
+		}
+		x_ = component(xs);
+		y_ = component(ys);
+	}
+
+private:
+	Point points_[N + 1];
+	Component x_, y_;
+};
+
+/// Courbe de Bezier rationnelle de degre N: chaque point de controle porte
+/// un poids et la courbe est le quotient de deux courbes polynomiales,
+///     C(t) = somme w_i*p_i*B_i(t) / somme w_i*B_i(t)
+/// Les coniques (arcs de cercle et d'ellipse exacts) sont des rationnelles
+/// de degre 2.
+template <unsigned int N>
+class RationalBezierN {
+public:
+	typedef typename BezierN<N>::Component Component;
+
+	static const unsigned int Degree = N;
+
+public:
+	RationalBezierN()
+	{ }
+
+	RationalBezierN(const Point (&points)[N + 1], const real (&weights)[N + 1])
+	{
+		real xs[N + 1], ys[N + 1];
+		for (unsigned int i = 0; i <= N; ++i) {
+			points_[i] = points[i];
+			weights_[i] = weights[i];
+			xs[i] = weights[i]*points[i].x;
+			ys[i] = weights[i]*points[i].y;
+		}
+		x_ = BezierN<N>::component(xs);
+		y_ = BezierN<N>::component(ys);
+		w_ = BezierN<N>::component(weights);
+	}
+
+	/// Evalue la courbe pour la valeur donnee
+	Point operator()(real t) const
+	{
+		auto w = w_(t);
+		return {x_(t)/w, y_(t)/w};
+	}
+
+	/// Retourne le vecteur derive en t: (X'W - XW')/W^2 par composante.
+	Point derivative(real t) const
+	{
+		auto w = w_(t), dw = w_.derived()(t);
+		return {
+			(x_.derived()(t)*w - x_(t)*dw)/SQUARE(w),
+			(y_.derived()(t)*w - y_(t)*dw)/SQUARE(w)
+		};
+	}
+
+	/// Retourne le point de controle d'indice i (0 <= i <= N).
+	const Point & operator[](unsigned int i) const
+	{ return points_[i]; }
+
+	/// Retourne le poids du point de controle d'indice i.
+	real weight(unsigned int i) const
+	{ return weights_[i]; }
+
+	/// Retourne les polynomes homogenes (w*x, w*y, w) de la courbe.
+	const Component & x() const
+	{ return x_; }
+
+	const Component & y() const
+	{ return y_; }
+
+	const Component & w() const
+	{ return w_; }
+
+private:
+	Point points_[N + 1];
+	real weights_[N + 1];
+	Component x_, y_, w_;
+};
+
+template <unsigned int N, unsigned int J, unsigned int I>
+constexpr real bernstein::Coefficient<N, J, I>::Factor;
+
+template <unsigned int N, unsigned int J>
+constexpr real bernstein::Coefficient<N, J, J>::Factor;
+
+template <unsigned int N>
+const unsigned int BezierN<N>::Degree;
+
+template <unsigned int N>
+const unsigned int RationalBezierN<N>::Degree;
+}
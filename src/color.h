@@ -21,4 +21,13 @@ struct Color {
 	static const Color Green;
 	static const Color Blue;
 };
+
+inline bool operator==(const Color &a, const Color &b)
+{
+	return a.red == b.red && a.green == b.green
+		&& a.blue == b.blue && a.alpha == b.alpha;
+}
+
+inline bool operator!=(const Color &a, const Color &b)
+{ return ! (a == b); }
 }
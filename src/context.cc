@@ -2,6 +2,7 @@
 
 #include "error.h"
 #include "painter.h"
+#include "sdlbackend.h"
 #include "window.h"
 
 #include <SDL.h>
@@ -38,5 +39,5 @@ Context::createWindow(const std::string &title, uint16_t width, uint16_t height)
 std::shared_ptr<Painter>
 Context::createPainter(std::shared_ptr<Window> &window_ptr)
 {
-	return std::make_shared<Painter>(window_ptr);
+	return std::make_shared<Painter>(std::make_shared<SdlBackend>(window_ptr));
 }
@@ -0,0 +1,325 @@
+#include "curvebatch.h"
+
+#include <algorithm>
+#include <mutex>
+
+using namespace nealrame;
+
+struct CurveBatch::LazyBoxes {
+	std::once_flag once;
+	std::vector<Rect> boxes;
+};
+
+CurveBatch::CurveBatch(const Point *points, size_type count) :
+	CurveBatch()
+{
+	append(points, count);
+}
+
+CurveBatch::CurveBatch(
+	std::shared_ptr<const void> storage,
+	const real *const components[Components], size_type count,
+	const Rect *boxes) :
+	storage_(storage),
+	viewSize_(count),
+	viewBoxes_(boxes)
+{
+	std::copy(components, components + Components, view_);
+	if (! viewBoxes_) {
+		lazyBoxes_ = std::make_shared<LazyBoxes>();
+	}
+}
+
+CurveBatch::size_type CurveBatch::size() const
+{ return storage_ ? viewSize_ : points_[P1X].size(); }
+
+bool CurveBatch::empty() const
+{ return size() == 0; }
+
+void CurveBatch::reserve(size_type count)
+{
+	detach();
+	for (auto &v: points_) v.reserve(count);
+	boxes_.reserve(count);
+}
+
+void CurveBatch::clear()
+{
+	storage_.reset();
+	viewBoxes_ = nullptr;
+	lazyBoxes_.reset();
+	resize(0);
+}
+
+void CurveBatch::push_back(const Bezier &c)
+{
+	push_back(c.p1(), c.ctrl1(), c.ctrl2(), c.p2());
+}
+
+void CurveBatch::push_back(const Point &p0, const Point &p1, const Point &p2, const Point &p3)
+{
+	detach();
+
+	points_[P1X].push_back(p0.x);
+	points_[P1Y].push_back(p0.y);
+	points_[C1X].push_back(p1.x);
+	points_[C1Y].push_back(p1.y);
+	points_[C2X].push_back(p2.x);
+	points_[C2Y].push_back(p2.y);
+	points_[P2X].push_back(p3.x);
+	points_[P2Y].push_back(p3.y);
+
+	boxes_.push_back(Bezier(p0, p1, p2, p3).boudingBox());
+}
+
+void CurveBatch::append(const Point *points, size_type count)
+{
+	detach();
+
+	auto first = size();
+
+	resize(first + count);
+	for (size_type i = 0; i < count; ++i, points += 4) {
+		for (unsigned int k = 0; k < 4; ++k) {
+			points_[2*k][first + i] = points[k].x;
+			points_[2*k + 1][first + i] = points[k].y;
+		}
+	}
+	computeBoxes(first, boxes_.data());
+}
+
+Bezier CurveBatch::operator[](size_type i) const
+{
+	return Bezier(p1(i), ctrl1(i), ctrl2(i), p2(i));
+}
+
+Point CurveBatch::p1(size_type i) const
+{ return point(P1X, i); }
+
+Point CurveBatch::p2(size_type i) const
+{ return point(P2X, i); }
+
+Point CurveBatch::ctrl1(size_type i) const
+{ return point(C1X, i); }
+
+Point CurveBatch::ctrl2(size_type i) const
+{ return point(C2X, i); }
+
+const Rect * CurveBatch::boundingBoxes() const
+{
+	if (viewBoxes_) {
+		return viewBoxes_;
+	}
+	if (lazyBoxes_) {
+		auto &lazy = *lazyBoxes_;
+		std::call_once(lazy.once, [&] {
+			lazy.boxes.resize(size());
+			computeBoxes(0, lazy.boxes.data());
+		});
+		return lazy.boxes.data();
+	}
+	return boxes_.data();
+}
+
+void CurveBatch::boundingBoxes(Rect *out) const
+{
+	auto boxes = boundingBoxes();
+	std::copy(boxes, boxes + size(), out);
+}
+
+void CurveBatch::controlBoxes(Rect *out) const
+{
+	const real *x0 = component(P1X), *x1 = component(C1X), *x2 = component(C2X), *x3 = component(P2X);
+	const real *y0 = component(P1Y), *y1 = component(C1Y), *y2 = component(C2Y), *y3 = component(P2Y);
+
+	for (size_type i = 0, count = size(); i < count; ++i) {
+		out[i] = Rect(
+			{
+				std::min(std::min(x0[i], x1[i]), std::min(x2[i], x3[i])),
+				std::min(std::min(y0[i], y1[i]), std::min(y2[i], y3[i]))
+			},
+			{
+				std::max(std::max(x0[i], x1[i]), std::max(x2[i], x3[i])),
+				std::max(std::max(y0[i], y1[i]), std::max(y2[i], y3[i]))
+			}
+		);
+	}
+}
+
+/// Ecrit dans out les bouding boxes des courbes de first a size() exclus.
+void CurveBatch::computeBoxes(size_type first, Rect *out) const
+{
+	const size_type Block = 256;
+
+	const real *x0 = component(P1X), *x1 = component(C1X), *x2 = component(C2X), *x3 = component(P2X);
+	const real *y0 = component(P1Y), *y1 = component(C1Y), *y2 = component(C2Y), *y3 = component(P2Y);
+	real minX[Block], maxX[Block], minY[Block], maxY[Block];
+	unsigned char exact[Block];
+	auto count = size();
+
+	for (auto block = first; block < count; block += Block) {
+		auto n = std::min(Block, count - block);
+
+		for (size_type k = 0; k < n; ++k) {
+			auto i = block + k;
+			auto ex0 = std::min(x0[i], x3[i]), ex1 = std::max(x0[i], x3[i]);
+			auto ey0 = std::min(y0[i], y3[i]), ey1 = std::max(y0[i], y3[i]);
+			auto cx0 = std::min(x1[i], x2[i]), cx1 = std::max(x1[i], x2[i]);
+			auto cy0 = std::min(y1[i], y2[i]), cy1 = std::max(y1[i], y2[i]);
+			minX[k] = std::min(ex0, cx0);
+			maxX[k] = std::max(ex1, cx1);
+			minY[k] = std::min(ey0, cy0);
+			maxY[k] = std::max(ey1, cy1);
+			exact[k] = (cx0 >= ex0) & (cx1 <= ex1) & (cy0 >= ey0) & (cy1 <= ey1);
+		}
+
+		for (size_type k = 0; k < n; ++k) {
+			auto i = block + k;
+			if (! exact[k]) {
+				Bezier::extent(x0[i], x1[i], x2[i], x3[i], minX[k], maxX[k]);
+				Bezier::extent(y0[i], y1[i], y2[i], y3[i], minY[k], maxY[k]);
+			}
+			out[i] = Rect({minX[k], minY[k]}, {maxX[k], maxY[k]});
+		}
+	}
+}
+
+/// Les courbes sont parcourues par blocs: l'ecart de p a la boite des
+/// points de controle de chaque courbe du bloc est d'abord calcule sans
+/// branchement (boucle vectorisable sur les tableaux de composantes),
+/// puis seules les courbes dont l'ecart est inferieur a la meilleure
+/// distance sont examinees.
+bool CurveBatch::nearest(
+	const Point &p, real radius, size_type &found, Bezier::Projection *projection) const
+{
+	const size_type Block = 256;
+
+	const real *x0 = component(P1X), *x1 = component(C1X), *x2 = component(C2X), *x3 = component(P2X);
+	const real *y0 = component(P1Y), *y1 = component(C1Y), *y2 = component(C2Y), *y3 = component(P2Y);
+	auto boxes = boundingBoxes();
+	real gaps[Block];
+	auto best = radius;
+	auto hit = false;
+
+	for (size_type first = 0, count = size(); first < count; first += Block) {
+		auto n = std::min(Block, count - first);
+
+		for (size_type k = 0; k < n; ++k) {
+			auto i = first + k;
+			auto minX = std::min(std::min(x0[i], x1[i]), std::min(x2[i], x3[i]));
+			auto maxX = std::max(std::max(x0[i], x1[i]), std::max(x2[i], x3[i]));
+			auto minY = std::min(std::min(y0[i], y1[i]), std::min(y2[i], y3[i]));
+			auto maxY = std::max(std::max(y0[i], y1[i]), std::max(y2[i], y3[i]));
+			gaps[k] = std::max(std::max(minX - p.x, p.x - maxX), std::max(minY - p.y, p.y - maxY));
+		}
+
+		for (size_type k = 0; k < n; ++k) {
+			if (gaps[k] > best) continue;
+
+			auto curve = (*this)[first + k];
+			auto &box = boxes[first + k];
+			auto dx = std::max(std::max(box.topLeft().x - p.x, p.x - box.bottomRight().x), real(0));
+			auto dy = std::max(std::max(box.topLeft().y - p.y, p.y - box.bottomRight().y), real(0));
+			if (SQUARE(dx) + SQUARE(dy) > SQUARE(best)) continue;
+
+			auto projected = curve.project(p);
+			if (projected.distance <= best) {
+				best = projected.distance;
+				found = first + k;
+				hit = true;
+				if (projection) {
+					*projection = projected;
+				}
+			}
+		}
+	}
+	return hit;
+}
+
+/// Les points sont obtenus dans la base de Bernstein, dont les poids ne
+/// dependent que de t: chaque point coute 4 multiplications et 3 additions
+/// par composante, comme le schema de Horner, sans qu'il faille stocker les
+/// coefficients. Les boucles parcourent des tableaux contigus et sans
+/// dependances entre iterations: le compilateur peut les vectoriser.
+void CurveBatch::evaluate(real t, real *xs, real *ys) const
+{
+	auto s = 1 - t;
+	auto b0 = s*s*s, b1 = 3*s*s*t, b2 = 3*s*t*t, b3 = t*t*t;
+
+	auto blend = [&](Component p1, Component c1, Component c2, Component p2, real *out) {
+		const real *v0 = component(p1), *v1 = component(c1), *v2 = component(c2), *v3 = component(p2);
+
+		for (size_type i = 0, count = size(); i < count; ++i) {
+			out[i] = b0*v0[i] + b1*v1[i] + b2*v2[i] + b3*v3[i];
+		}
+	};
+
+	blend(P1X, C1X, C2X, P2X, xs);
+	blend(P1Y, C1Y, C2Y, P2Y, ys);
+}
+
+void CurveBatch::evaluate(const real *ts, std::size_t count, real *xs, real *ys) const
+{
+	for (size_type i = 0, curves = size(); i < curves; ++i) {
+		xPolynomial(i).evaluate(ts, count, xs + i*count);
+		yPolynomial(i).evaluate(ts, count, ys + i*count);
+	}
+}
+
+void CurveBatch::flatten(size_type i, Polyline &polyline, real tolerance) const
+{
+	auto n = segmentCount(p1(i), ctrl1(i), ctrl2(i), p2(i), tolerance);
+	auto stepper = Bezier::Stepper(xPolynomial(i), yPolynomial(i), n);
+
+	polyline.reserve(polyline.size() + n + 1);
+	polyline.push_back(p1(i));
+	for (unsigned int k = 1; k < n; ++k) {
+		stepper.step();
+		polyline.push_back(stepper.point());
+	}
+	polyline.push_back(p2(i));
+}
+
+/// Calcule les coefficients d'une composante a partir des points de
+/// controle (voir BezierN<3>::component()).
+static Bezier::Polynomial polynomial(real p0, real p1, real p2, real p3)
+{
+	const real values[] = {p0, p1, p2, p3};
+	return BezierN<3>::component(values);
+}
+
+Bezier::Polynomial CurveBatch::xPolynomial(size_type i) const
+{
+	return polynomial(
+		component(P1X)[i], component(C1X)[i], component(C2X)[i], component(P2X)[i]
+	);
+}
+
+Bezier::Polynomial CurveBatch::yPolynomial(size_type i) const
+{
+	return polynomial(
+		component(P1Y)[i], component(C1Y)[i], component(C2Y)[i], component(P2Y)[i]
+	);
+}
+
+void CurveBatch::resize(size_type count)
+{
+	for (auto &v: points_) v.resize(count);
+	boxes_.resize(count);
+}
+
+/// Copie les tableaux references avant une modification.
+void CurveBatch::detach()
+{
+	if (! storage_) return;
+
+	auto boxes = boundingBoxes();
+	boxes_.assign(boxes, boxes + viewSize_);
+	viewBoxes_ = nullptr;
+	lazyBoxes_.reset();
+
+	for (unsigned int c = 0; c < Components; ++c) {
+		points_[c].assign(view_[c], view_[c] + viewSize_);
+	}
+	storage_.reset();
+}
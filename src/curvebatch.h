@@ -0,0 +1,144 @@
+#pragma once
+
+#include "bezier.h"
+#include "common.h"
+#include "flatten.h"
+#include "point.h"
+#include "rect.h"
+
+#include <memory>
+#include <vector>
+
+namespace nealrame
+{
+/// Lot de courbes de Bezier cubiques range par composantes (structure de
+/// tableaux): chaque coordonnee des points de controle est stockee dans son
+/// propre tableau contigu. Les coefficients des polynomes sont recalcules a
+/// la demande, ce qui permet aussi d'utiliser directement des tableaux
+/// exterieurs au lot (voir CurveFile).
+class CurveBatch {
+public:
+	typedef std::vector<real>::size_type size_type;
+
+	enum Component {
+		P1X, P1Y, C1X, C1Y, C2X, C2Y, P2X, P2Y, Components
+	};
+
+public:
+	CurveBatch() :
+		view_(),
+		viewSize_(0),
+		viewBoxes_(nullptr)
+	{ }
+
+	/// Construit le lot a partir de count courbes dont les points de
+	/// controle sont ranges consecutivement dans points (4 par courbe:
+	/// extremite, controle, controle, extremite).
+	CurveBatch(const Point *points, size_type count);
+
+	/// Construit un lot de count courbes referencant, sans les copier, les
+	/// tableaux components (un par Component, de count valeurs chacun).
+	/// storage maintient ces tableaux en vie tant que le lot (ou une de ses
+	/// copies) les utilise. Les tableaux sont copies a la premiere
+	/// modification du lot. Les bouding boxes des courbes sont referencees
+	/// de la meme facon dans boxes si ce tableau n'est pas nul; sinon,
+	/// elles ne sont calculees qu'au premier appel de boundingBoxes().
+	CurveBatch(
+		std::shared_ptr<const void> storage,
+		const real *const components[Components], size_type count,
+		const Rect *boxes = nullptr);
+
+	size_type size() const;
+	bool empty() const;
+
+	void reserve(size_type count);
+	void clear();
+
+	void push_back(const Bezier &);
+	void push_back(const Point &, const Point &, const Point &, const Point &);
+
+	/// Ajoute count courbes, 4 points de controle par courbe.
+	void append(const Point *points, size_type count);
+
+	/// Retourne la courbe d'indice i.
+	Bezier operator[](size_type i) const;
+
+	Point p1(size_type i) const;
+	Point p2(size_type i) const;
+	Point ctrl1(size_type i) const;
+	Point ctrl2(size_type i) const;
+
+	/// Retourne les size() bouding boxes des courbes. Elles sont tenues a
+	/// jour a chaque ajout de courbes; celles d'un lot referencant des
+	/// tableaux sans boites sont calculees une seule fois, au premier
+	/// appel, qui peut avoir lieu depuis plusieurs threads a la fois.
+	///
+	/// Le calcul procede par blocs: la boite des points de controle et le
+	/// fait que les controles sont compris entre les extremites sont
+	/// d'abord obtenus sans branchement (boucle vectorisable sur les
+	/// tableaux de composantes); dans ce cas, le plus courant, la boite
+	/// des controles est la bouding box. Les extremums des autres courbes
+	/// sont ensuite calcules (voir Bezier::extent()).
+	const Rect * boundingBoxes() const;
+
+	/// Ecrit la bouding box de chaque courbe dans out.
+	void boundingBoxes(Rect *out) const;
+
+	/// Ecrit la boite des points de controle de chaque courbe dans out
+	/// (voir Bezier::controlBox()).
+	void controlBoxes(Rect *out) const;
+
+	/// Recherche la courbe la plus proche de p, a une distance au plus
+	/// radius, et ecrit son indice dans found (et sa projection dans
+	/// projection s'il n'est pas nul). Retourne false si aucune courbe
+	/// n'est assez proche.
+	///
+	/// Les courbes sont d'abord ecartees par la boite de leurs points de
+	/// controle, puis par leur boite englobante (voir boundingBoxes()),
+	/// toutes deux elargies de la plus petite distance trouvee jusque-la:
+	/// seules les courbes restantes sont projetees (voir
+	/// Bezier::project()).
+	bool nearest(
+		const Point &p, real radius, size_type &found,
+		Bezier::Projection *projection = nullptr) const;
+
+	/// Evalue toutes les courbes pour la valeur t. Le point de la courbe i
+	/// est ecrit dans (xs[i], ys[i]).
+	void evaluate(real t, real *xs, real *ys) const;
+
+	/// Evalue toutes les courbes pour chacune des count valeurs de ts. Le
+	/// point de la courbe i pour ts[j] est (xs[i*count + j], ys[i*count + j]).
+	void evaluate(const real *ts, std::size_t count, real *xs, real *ys) const;
+
+	/// Approche la courbe d'indice i par une ligne brisee (voir flatten()).
+	void flatten(size_type i, Polyline &polyline, real tolerance = DefaultTolerance) const;
+
+	/// Retourne le tableau des size() valeurs de la composante c.
+	const real * component(Component c) const
+	{ return storage_ ? view_[c] : points_[c].data(); }
+
+private:
+	Point point(Component x, size_type i) const
+	{ return {component(x)[i], component(Component(x + 1))[i]}; }
+
+	Bezier::Polynomial xPolynomial(size_type i) const;
+	Bezier::Polynomial yPolynomial(size_type i) const;
+
+	void resize(size_type count);
+	void detach();
+	void computeBoxes(size_type first, Rect *out) const;
+
+private:
+	std::vector<real> points_[Components];
+	std::shared_ptr<const void> storage_;
+	const real *view_[Components];
+	size_type viewSize_;
+	std::vector<Rect> boxes_;
+	const Rect *viewBoxes_;
+
+	/// Boites calculees a la demande d'un lot referencant des tableaux
+	/// sans boites, partagees par ses copies.
+	struct LazyBoxes;
+	std::shared_ptr<LazyBoxes> lazyBoxes_;
+};
+}
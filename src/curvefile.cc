@@ -0,0 +1,374 @@
+#include "curvefile.h"
+
+#include "bezier.h"
+#include "error.h"
+#include "rect.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace nealrame;
+using namespace nealrame::curvefile;
+
+static_assert(sizeof(real) == 4, "curve files store float32 values");
+static_assert(
+	sizeof(Rect) == 4*sizeof(real) && std::is_standard_layout<Rect>::value,
+	"bounding boxes are mapped as Rect"
+);
+
+namespace
+{
+const char Magic[8] = {'N', 'R', 'C', 'U', 'R', 'V', 'E', 'S'};
+const uint32_t ByteOrder = 0x01020304;
+
+struct Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t flags;
+	uint32_t reserved;
+	uint64_t count;
+	uint64_t offsets[Sections];
+};
+
+static_assert(sizeof(Header) <= HeaderSize, "header does not fit");
+
+std::size_t itemSize(unsigned int section)
+{
+	switch (section) {
+	case BoundingBoxes:
+		return sizeof(Rect);
+	case Styles:
+		return sizeof(uint32_t);
+	default:
+		return sizeof(real);
+	}
+}
+
+bool present(unsigned int section, uint32_t flags)
+{
+	switch (section) {
+	case BoundingBoxes:
+		return flags & HasBoundingBoxes;
+	case Styles:
+		return flags & HasStyles;
+	default:
+		return true;
+	}
+}
+
+/// Place les sections presentes d'un fichier de count courbes les unes a la
+/// suite des autres. Retourne la taille du fichier.
+uint64_t layout(uint64_t count, uint32_t flags, uint64_t offsets[Sections])
+{
+	uint64_t offset = HeaderSize;
+
+	for (unsigned int section = 0; section < Sections; ++section) {
+		if (! present(section, flags)) {
+			offsets[section] = 0;
+			continue;
+		}
+		offset = (offset + SectionAlignment - 1)/SectionAlignment*SectionAlignment;
+		offsets[section] = offset;
+		offset += count*itemSize(section);
+	}
+	return offset;
+}
+
+Error systemError(const std::string &what, const std::string &path)
+{
+	return Error(what + " " + path + ": " + std::strerror(errno));
+}
+
+/// Projection en memoire d'un fichier, liberee avec le dernier lot qui
+/// la reference.
+struct Mapping {
+	Mapping(void *data, std::size_t size) :
+		data(data), size(size)
+	{ }
+
+	~Mapping()
+	{
+		munmap(data, size);
+	}
+
+	void *data;
+	std::size_t size;
+};
+}
+
+struct CurveFile::Impl {
+	CurveBatch curves;
+	const Rect *boxes = nullptr;
+	const uint32_t *styles = nullptr;
+};
+
+/// Seul l'en-tete est verifie: chaque section presente doit etre alignee et
+/// contenue dans le fichier.
+CurveFile::CurveFile(const std::string &path) :
+	d_(new Impl)
+{
+	auto fd = open(path.c_str(), O_RDONLY|O_CLOEXEC);
+	if (fd < 0) {
+		throw systemError("cannot open", path);
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		auto error = systemError("cannot stat", path);
+		::close(fd);
+		throw error;
+	}
+	if (uint64_t(st.st_size) < HeaderSize) {
+		::close(fd);
+		throw Error(path + ": not a curve file");
+	}
+
+	auto size = std::size_t(st.st_size);
+	auto data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		throw systemError("cannot map", path);
+	}
+
+	auto mapping = std::make_shared<Mapping>(data, size);
+	auto bytes = static_cast<const char *>(data);
+
+	Header header;
+	std::memcpy(&header, bytes, sizeof(header));
+
+	if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+		throw Error(path + ": not a curve file");
+	}
+	if (header.byteOrder != ByteOrder) {
+		throw Error(path + ": unsupported byte order");
+	}
+	if (header.version != Version) {
+		throw Error(path + ": unsupported version " + std::to_string(header.version));
+	}
+	if (header.flags & ~uint32_t(HasBoundingBoxes|HasStyles)) {
+		throw Error(path + ": unsupported flags");
+	}
+
+	const void *sections[Sections] = {};
+	for (unsigned int section = 0; section < Sections; ++section) {
+		if (! present(section, header.flags)) continue;
+
+		auto offset = header.offsets[section];
+		if (offset < HeaderSize || offset > size || offset%itemSize(section) != 0
+			|| header.count > (size - offset)/itemSize(section)) {
+			throw Error(path + ": truncated or corrupted");
+		}
+		sections[section] = bytes + offset;
+	}
+
+	const real *components[CurveBatch::Components];
+	for (unsigned int c = 0; c < CurveBatch::Components; ++c) {
+		components[c] = static_cast<const real *>(sections[c]);
+	}
+
+	d_->boxes = static_cast<const Rect *>(sections[BoundingBoxes]);
+	d_->curves = CurveBatch(mapping, components, CurveBatch::size_type(header.count), d_->boxes);
+	d_->styles = static_cast<const uint32_t *>(sections[Styles]);
+}
+
+CurveFile::CurveFile(CurveFile &&rhs)
+{
+	*this = std::move(rhs);
+}
+
+CurveFile::~CurveFile()
+{ }
+
+CurveFile & CurveFile::operator=(CurveFile &&rhs)
+{
+	d_ = std::move(rhs.d_);
+	return *this;
+}
+
+CurveBatch::size_type CurveFile::size() const
+{
+	return d_->curves.size();
+}
+
+const CurveBatch & CurveFile::curves() const
+{
+	return d_->curves;
+}
+
+const Rect * CurveFile::boundingBoxes() const
+{
+	return d_->boxes;
+}
+
+const uint32_t * CurveFile::styles() const
+{
+	return d_->styles;
+}
+
+struct CurveWriter::Impl {
+	static const std::size_t BufferSize = 64*1024;
+
+	std::string path;
+	int fd = -1;
+	uint64_t count = 0, written = 0;
+	uint32_t flags = 0;
+	uint64_t positions[Sections];
+	std::vector<char> buffers[Sections];
+
+	void put(unsigned int section, const void *data, std::size_t size);
+	void flush(unsigned int section);
+	void pwrite(const void *data, std::size_t size, uint64_t offset);
+};
+
+void CurveWriter::Impl::put(unsigned int section, const void *data, std::size_t size)
+{
+	auto &buffer = buffers[section];
+	auto bytes = static_cast<const char *>(data);
+
+	buffer.insert(buffer.end(), bytes, bytes + size);
+	if (buffer.size() >= BufferSize) {
+		flush(section);
+	}
+}
+
+void CurveWriter::Impl::flush(unsigned int section)
+{
+	auto &buffer = buffers[section];
+
+	pwrite(buffer.data(), buffer.size(), positions[section]);
+	positions[section] += buffer.size();
+	buffer.clear();
+}
+
+void CurveWriter::Impl::pwrite(const void *data, std::size_t size, uint64_t offset)
+{
+	auto bytes = static_cast<const char *>(data);
+
+	while (size > 0) {
+		auto n = ::pwrite(fd, bytes, size, off_t(offset));
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			throw systemError("cannot write", path);
+		}
+		bytes += n;
+		size -= std::size_t(n);
+		offset += uint64_t(n);
+	}
+}
+
+/// Le fichier est d'emblee porte a sa taille finale: le remplissage entre
+/// les sections est fait de zeros.
+CurveWriter::CurveWriter(const std::string &path, uint64_t count, unsigned int flags) :
+	d_(new Impl)
+{
+	d_->path = path;
+	d_->count = count;
+	d_->flags = flags & (HasBoundingBoxes|HasStyles);
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.byteOrder = ByteOrder;
+	header.flags = d_->flags;
+	header.count = count;
+
+	auto size = layout(count, d_->flags, header.offsets);
+	std::copy(header.offsets, header.offsets + Sections, d_->positions);
+
+	d_->fd = open(path.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+	if (d_->fd < 0) {
+		throw systemError("cannot create", path);
+	}
+	if (ftruncate(d_->fd, off_t(size)) < 0) {
+		auto error = systemError("cannot resize", path);
+		::close(d_->fd);
+		throw error;
+	}
+
+	try {
+		d_->pwrite(&header, sizeof(header), 0);
+	} catch (...) {
+		::close(d_->fd);
+		throw;
+	}
+
+	for (auto &buffer: d_->buffers) {
+		buffer.reserve(Impl::BufferSize + sizeof(Rect));
+	}
+}
+
+CurveWriter::~CurveWriter()
+{
+	try {
+		close();
+	} catch (...) {
+	}
+}
+
+void CurveWriter::write(const Bezier &curve, uint32_t style)
+{
+	if (d_->fd < 0) {
+		throw Error("CurveWriter: file is closed");
+	}
+	if (d_->written == d_->count) {
+		throw Error("CurveWriter: more curves than announced");
+	}
+
+	const Point points[] = {curve.p1(), curve.ctrl1(), curve.ctrl2(), curve.p2()};
+	for (unsigned int k = 0; k < 4; ++k) {
+		d_->put(2*k, &points[k].x, sizeof(real));
+		d_->put(2*k + 1, &points[k].y, sizeof(real));
+	}
+	if (d_->flags & HasBoundingBoxes) {
+		auto box = curve.boudingBox();
+		d_->put(BoundingBoxes, &box, sizeof(box));
+	}
+	if (d_->flags & HasStyles) {
+		d_->put(Styles, &style, sizeof(style));
+	}
+	++d_->written;
+}
+
+void CurveWriter::write(const CurveBatch &batch, const uint32_t *styles)
+{
+	for (CurveBatch::size_type i = 0, count = batch.size(); i < count; ++i) {
+		write(batch[i], styles ? styles[i] : 0);
+	}
+}
+
+void CurveWriter::close()
+{
+	if (d_->fd < 0) return;
+
+	auto fd = d_->fd;
+	try {
+		for (unsigned int section = 0; section < Sections; ++section) {
+			d_->flush(section);
+		}
+	} catch (...) {
+		d_->fd = -1;
+		::close(fd);
+		throw;
+	}
+
+	d_->fd = -1;
+	if (::close(fd) < 0) {
+		throw systemError("cannot write", d_->path);
+	}
+	if (d_->written != d_->count) {
+		throw Error(
+			"CurveWriter: " + std::to_string(d_->written) + " curves written, "
+			+ std::to_string(d_->count) + " announced"
+		);
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "common.h"
+#include "curvebatch.h"
+
+#include <string>
+
+namespace nealrame
+{
+class Bezier;
+class Rect;
+
+/// Format binaire des lots de courbes (version 1).
+///
+/// Le fichier commence par un en-tete de HeaderSize octets:
+///
+///     char     magic[8]        "NRCURVES"
+///     uint32   version         1
+///     uint32   byteOrder       0x01020304, ecrit dans l'ordre natif
+///     uint32   flags           HasBoundingBoxes, HasStyles
+///     uint32   reserved        0
+///     uint64   count           nombre de courbes
+///     uint64   offsets[10]     position des sections (0 si absente)
+///
+/// suivi des sections, chacune alignee sur SectionAlignment octets:
+///
+///   - 8 tableaux de count float32, un par CurveBatch::Component (p1.x,
+///     p1.y, ctrl1.x, ctrl1.y, ctrl2.x, ctrl2.y, p2.x, p2.y);
+///   - si HasBoundingBoxes, count boites (x0, y0, x1, y1 en float32), telles
+///     que calculees par Bezier::boudingBox();
+///   - si HasStyles, count indices de style uint32.
+///
+/// Les sections sont disposees exactement comme en memoire: un fichier
+/// projete en memoire est utilise tel quel, sans lecture ni copie.
+namespace curvefile
+{
+const unsigned int Version = 1;
+const std::size_t HeaderSize = 128;
+const std::size_t SectionAlignment = 64;
+
+enum Flags {
+	HasBoundingBoxes = 1 << 0,
+	HasStyles = 1 << 1
+};
+
+enum Section {
+	BoundingBoxes = CurveBatch::Components,
+	Styles,
+	Sections
+};
+}
+
+/// Fichier de courbes projete en memoire (voir curvefile). L'ouverture ne
+/// lit que l'en-tete: les pages ne sont chargees qu'a leur premier acces,
+/// si bien qu'un fichier de plusieurs gigaoctets s'ouvre en un temps
+/// constant. Les donnees restent valides tant que le CurveFile ou une copie
+/// du lot retourne par curves() existe.
+class CurveFile {
+	PIMPL;
+
+	CurveFile(const CurveFile &) = delete;
+	CurveFile & operator=(const CurveFile &) = delete;
+
+public:
+	/// Ouvre le fichier. Leve une Error s'il n'existe pas ou n'est pas un
+	/// fichier de courbes valide.
+	CurveFile(const std::string &path);
+	CurveFile(CurveFile &&);
+	~CurveFile();
+
+	CurveFile & operator=(CurveFile &&);
+
+	CurveBatch::size_type size() const;
+
+	/// Courbes du fichier, referencant directement la projection.
+	const CurveBatch & curves() const;
+
+	/// Boites englobantes des courbes, ou nullptr si le fichier n'en
+	/// contient pas.
+	const Rect * boundingBoxes() const;
+
+	/// Indices de style des courbes, ou nullptr si le fichier n'en contient
+	/// pas.
+	const uint32_t * styles() const;
+};
+
+/// Ecrit un fichier de courbes au fil de l'eau: chaque section est
+/// accumulee dans un petit tampon ecrit a sa position des qu'il est plein,
+/// si bien que la memoire utilisee ne depend pas du nombre de courbes. Ce
+/// nombre doit etre connu a l'avance, pour placer les sections.
+class CurveWriter {
+	PIMPL;
+
+	CurveWriter(const CurveWriter &) = delete;
+	CurveWriter & operator=(const CurveWriter &) = delete;
+
+public:
+	/// Cree (ou remplace) le fichier path, destine a recevoir count
+	/// courbes. flags est une combinaison de curvefile::Flags.
+	CurveWriter(const std::string &path, uint64_t count, unsigned int flags = 0);
+
+	/// Ferme le fichier sans lever d'exception (voir close()).
+	~CurveWriter();
+
+	/// Ajoute une courbe, avec son indice de style (ignore si le fichier
+	/// n'a pas de section HasStyles).
+	void write(const Bezier &, uint32_t style = 0);
+
+	/// Ajoute les courbes d'un lot, avec leurs styles si styles n'est pas
+	/// nul.
+	void write(const CurveBatch &, const uint32_t *styles = nullptr);
+
+	/// Ecrit les donnees en attente et ferme le fichier. Leve une Error si
+	/// le nombre de courbes ecrites differe de celui annonce ou si une
+	/// ecriture a echoue.
+	void close();
+};
+}
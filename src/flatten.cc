@@ -0,0 +1,62 @@
+#include "flatten.h"
+
+#include "bezier.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace nealrame;
+
+/// Retourne la norme de la difference seconde p0 - 2p1 + p2.
+static real secondDifference(const Point &p0, const Point &p1, const Point &p2)
+{
+	return std::sqrt(
+		SQUARE(p0.x - 2*p1.x + p2.x) + SQUARE(p0.y - 2*p1.y + p2.y)
+	);
+}
+
+/// On utilise la formule de Wang: pour une courbe de degre n, une
+/// subdivision uniforme en
+///     N = sqrt(n(n - 1)/8 * M/tolerance)
+/// segments, ou M est la plus grande norme des differences secondes des
+/// points de controle, garantit un ecart inferieur a tolerance.
+///
+/// Pour plus d'infos consulter:
+///   http://pomax.github.io/bezierinfo/#flattening
+unsigned int nealrame::segmentCount(
+	const Point &p0, const Point &p1, const Point &p2, const Point &p3,
+	real tolerance)
+{
+	auto m = std::max(
+		secondDifference(p0, p1, p2),
+		secondDifference(p1, p2, p3)
+	);
+
+	if (! (tolerance > 0)) {
+		return MaxSegmentCount;
+	}
+
+	auto n = std::ceil(std::sqrt(3*m/(4*tolerance)));
+
+	return n <= 1 ? 1 : std::min<real>(n, MaxSegmentCount);
+}
+
+unsigned int nealrame::segmentCount(const Bezier &c, real tolerance)
+{
+	return segmentCount(c.p1(), c.ctrl1(), c.ctrl2(), c.p2(), tolerance);
+}
+
+void nealrame::flatten(const Bezier &c, Polyline &polyline, real tolerance)
+{
+	auto n = segmentCount(c, tolerance);
+
+	auto stepper = c.stepper(n);
+
+	polyline.reserve(polyline.size() + n + 1);
+	polyline.push_back(c.p1());
+	for (unsigned int i = 1; i < n; ++i) {
+		stepper.step();
+		polyline.push_back(stepper.point());
+	}
+	polyline.push_back(c.p2());
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "common.h"
+#include "point.h"
+
+#include <vector>
+
+namespace nealrame
+{
+class Bezier;
+
+using Polyline = std::vector<Point>;
+
+/// Ecart maximal par defaut, en pixels, entre une courbe et la ligne brisee
+/// qui l'approche.
+const real DefaultTolerance = .25;
+
+/// Nombre maximal de segments produits pour une courbe.
+const unsigned int MaxSegmentCount = 256;
+
+/// Retourne le nombre de segments necessaires pour que la ligne brisee
+/// approchant la courbe s'en ecarte d'au plus tolerance.
+unsigned int segmentCount(const Bezier &, real tolerance = DefaultTolerance);
+
+/// Retourne le nombre de segments necessaires pour la courbe de points de
+/// controle p0, p1, p2 et p3.
+unsigned int segmentCount(
+	const Point &p0, const Point &p1, const Point &p2, const Point &p3,
+	real tolerance = DefaultTolerance);
+
+/// Approche la courbe par une ligne brisee s'en ecartant d'au plus
+/// tolerance. Les points sont ajoutes a la fin de polyline.
+void flatten(const Bezier &, Polyline &polyline, real tolerance = DefaultTolerance);
+}
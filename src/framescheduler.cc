@@ -0,0 +1,58 @@
+#include "framescheduler.h"
+
+#include <algorithm>
+
+using namespace nealrame;
+
+FrameScheduler::FrameScheduler(unsigned int framesPerSecond) :
+	period_(std::chrono::duration_cast<Clock::duration>(
+		std::chrono::seconds(1))/std::max(framesPerSecond, 1u)),
+	active_(false)
+{ }
+
+void FrameScheduler::animate(Clock::duration duration)
+{
+	auto now = Clock::now();
+
+	if (! active_) {
+		next_ = now;
+		end_ = now;
+		active_ = true;
+	}
+	end_ = std::max(end_, now + duration);
+}
+
+bool FrameScheduler::animating() const
+{
+	return active_;
+}
+
+int FrameScheduler::timeout() const
+{
+	if (! active_) return -1;
+
+	// Arrondi a la milliseconde superieure: s'eveiller un peu avant
+	// l'echeance ferait tourner la boucle a vide jusqu'a celle-ci.
+	auto delay = std::chrono::duration_cast<std::chrono::microseconds>(next_ - Clock::now()).count();
+	return delay > 0 ? int((delay + 999)/1000) : 0;
+}
+
+bool FrameScheduler::frameDue()
+{
+	if (! active_) return false;
+
+	auto now = Clock::now();
+
+	if (now < next_) return false;
+
+	if (now >= end_) {
+		active_ = false;
+	} else {
+		// Une image en retard n'entraine pas de rattrapage.
+		next_ += period_;
+		if (next_ <= now) {
+			next_ = now + period_;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common.h"
+
+#include <chrono>
+
+namespace nealrame
+{
+/// Cadence la boucle d'evenements d'une fenetre. Hors animation, rien ne
+/// justifie une nouvelle image avant le prochain evenement: la boucle
+/// l'attend sans limite de temps (voir Window::waitEvent()) et ne consomme
+/// aucun temps de calcul. Pendant une animation, l'attente est bornee par
+/// l'echeance de l'image suivante, a la frequence demandee.
+///
+///     FrameScheduler frames;
+///     do {
+///         window->waitEvent(frames.timeout());
+///         if (frames.frameDue()) {
+///             // avancer les animations, modifier la scene
+///         }
+///         if (scene.render(*painter)) {
+///             painter->present();
+///         }
+///     } while (cont);
+class FrameScheduler {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+public:
+	explicit FrameScheduler(unsigned int framesPerSecond = 60);
+
+	/// Produit des images pendant duration a partir de maintenant. Les
+	/// animations se recouvrent: la production s'arrete a la fin de la
+	/// derniere.
+	void animate(Clock::duration duration);
+
+	/// Indique si une animation est en cours.
+	bool animating() const;
+
+	/// Retourne le delai, en millisecondes, a accorder a l'attente d'un
+	/// evenement: jusqu'a l'image suivante pendant une animation, -1
+	/// (attente indefinie) sinon.
+	int timeout() const;
+
+	/// Indique si l'image suivante de l'animation est due. Si c'est le cas,
+	/// l'image d'apres est programmee une periode plus tard. La derniere
+	/// image due est celle qui suit la fin de l'animation, de sorte que
+	/// celle-ci se termine dans son etat final.
+	bool frameDue();
+
+private:
+	Clock::duration period_;
+	Clock::time_point next_;
+	Clock::time_point end_;
+	bool active_;
+};
+}
@@ -0,0 +1,103 @@
+#include "image.h"
+
+#include "color.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace nealrame;
+
+/// Retourne le mot de 32 bits dont la representation en memoire est la
+/// suite d'octets R, G, B, A.
+static uint32_t pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	const uint8_t bytes[] = {r, g, b, a};
+	uint32_t pixel;
+	std::memcpy(&pixel, bytes, sizeof(pixel));
+	return pixel;
+}
+
+Image::Image(int width, int height)
+{
+	resize(width, height);
+}
+
+int Image::width() const
+{ return width_; }
+
+int Image::height() const
+{ return height_; }
+
+void Image::resize(int width, int height)
+{
+	width_ = std::max(width, 0);
+	height_ = std::max(height, 0);
+	pixels_.assign(std::size_t(width_)*height_, 0);
+}
+
+void Image::fill(const Color &c)
+{
+	std::fill(pixels_.begin(), pixels_.end(), pack(c.red, c.green, c.blue, c.alpha));
+}
+
+void Image::fill(int x0, int y0, int x1, int y1, const Color &c)
+{
+	auto pixel = pack(c.red, c.green, c.blue, c.alpha);
+
+	x0 = std::max(x0, 0);
+	x1 = std::min(x1, width_);
+	for (auto y = std::max(y0, 0), end = std::min(y1, height_); y < end && x0 < x1; ++y) {
+		std::fill_n(pixels_.data() + std::size_t(y)*width_ + x0, x1 - x0, pixel);
+	}
+}
+
+/// Les suites de pixels entierement couverts par une couleur opaque sont
+/// remplies d'un bloc (std::fill_n sur des mots de 32 bits, que le
+/// compilateur vectorise); les autres pixels sont composes un a un.
+void Image::blend(int y, int x0, int x1, const real *coverage, const Color &c)
+{
+	if (y < 0 || y >= height_) return;
+
+	auto begin = std::max(x0, 0), end = std::min(x1, width_);
+	auto pixels = pixels_.data() + std::size_t(y)*width_;
+	auto solid = pack(c.red, c.green, c.blue, c.alpha);
+	auto opacity = real(c.alpha)/255;
+
+	for (auto x = begin; x < end;) {
+		auto alpha = coverage[x - x0]*opacity;
+
+		if (alpha >= 1) {
+			auto run = x + 1;
+			while (run < end && coverage[run - x0] >= 1) ++run;
+			std::fill_n(pixels + x, run - x, solid);
+			x = run;
+			continue;
+		}
+
+		if (alpha > 0) {
+			uint8_t dst[4];
+			std::memcpy(dst, pixels + x, sizeof(dst));
+
+			auto mix = [alpha](uint8_t s, uint8_t d) {
+				return uint8_t(d + (s - d)*alpha + real(.5));
+			};
+			pixels[x] = pack(
+				mix(c.red, dst[0]),
+				mix(c.green, dst[1]),
+				mix(c.blue, dst[2]),
+				uint8_t(dst[3] + (255 - dst[3])*alpha + real(.5))
+			);
+		}
+		++x;
+	}
+}
+
+const uint8_t * Image::line(int y) const
+{
+	return data() + std::size_t(y)*width_*4;
+}
+
+const uint8_t * Image::data() const
+{
+	return reinterpret_cast<const uint8_t *>(pixels_.data());
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "common.h"
+
+#include <vector>
+
+namespace nealrame
+{
+struct Color;
+
+/// Image RGBA en memoire, 8 bits par composante, les pixels etant ranges
+/// ligne par ligne (octets R, G, B, A).
+class Image {
+public:
+	Image(int width = 0, int height = 0);
+
+	int width() const;
+	int height() const;
+
+	void resize(int width, int height);
+
+	/// Remplit l'image avec la couleur donnee.
+	void fill(const Color &);
+
+	/// Remplit les pixels (x, y) tels que x0 <= x < x1 et y0 <= y < y1.
+	void fill(int x0, int y0, int x1, int y1, const Color &);
+
+	/// Compose la couleur sur les pixels x0 a x1 exclus de la ligne y,
+	/// chacun avec l'opacite color.alpha*coverage[x - x0].
+	void blend(int y, int x0, int x1, const real *coverage, const Color &);
+
+	/// Retourne les octets de la ligne y.
+	const uint8_t * line(int y) const;
+	const uint8_t * data() const;
+
+private:
+	int width_, height_;
+	std::vector<uint32_t> pixels_;
+};
+}
@@ -0,0 +1,387 @@
+#include "intersection.h"
+
+#include "bezier.h"
+#include "rect.h"
+#include "spatialindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace nealrame;
+
+namespace
+{
+/// Au-dela, les courbes sont considerees comme confondues.
+const unsigned int MaxDepth = 64;
+
+/// Nombre maximal d'etapes de la recherche d'une paire de courbes: des
+/// courbes presque confondues sans l'etre exactement ne peuvent pas faire
+/// exploser la recherche.
+const unsigned int MaxSearchSteps = 4096;
+
+/// Nombre de points interieurs verifies pour confirmer une partie commune.
+const unsigned int OverlapSamples = 8;
+
+/// Si une etape de decoupage conserve plus de cette fraction de
+/// l'intervalle, la courbe est coupee en deux.
+const real MaxClipRatio = .8f;
+
+/// Portion [t0, t1] d'une courbe, decrite par ses points de controle.
+struct Segment {
+	Point p[4];
+	real t0, t1;
+
+	static Segment of(const Bezier &c)
+	{
+		return {{c.p1(), c.ctrl1(), c.ctrl2(), c.p2()}, 0, 1};
+	}
+
+	/// Portion [a, b] (en parametres locaux) de la portion.
+	Segment sub(real a, real b) const
+	{
+		Segment s;
+
+		BezierN<3>::subcurve(p, a, b, s.p);
+		s.t0 = t0 + a*(t1 - t0);
+		s.t1 = t0 + b*(t1 - t0);
+		return s;
+	}
+
+	/// Coupe la portion en son milieu (en parametres locaux).
+	void halve(Segment &left, Segment &right) const
+	{
+		BezierN<3>::split(p, .5, left.p, right.p);
+		left.t0 = t0;
+		left.t1 = right.t0 = (t0 + t1)/2;
+		right.t1 = t1;
+	}
+
+	/// Boite englobant les points de controle, et donc la portion.
+	void box(real &x0, real &y0, real &x1, real &y1) const
+	{
+		x0 = x1 = p[0].x;
+		y0 = y1 = p[0].y;
+		for (unsigned int i = 1; i < 4; ++i) {
+			x0 = std::min(x0, p[i].x);
+			x1 = std::max(x1, p[i].x);
+			y0 = std::min(y0, p[i].y);
+			y1 = std::max(y1, p[i].y);
+		}
+	}
+
+	real extent() const
+	{
+		real x0, y0, x1, y1;
+		box(x0, y0, x1, y1);
+		return std::max(x1 - x0, y1 - y0);
+	}
+};
+
+bool overlap(const Segment &a, const Segment &b, real tolerance)
+{
+	real ax0, ay0, ax1, ay1, bx0, by0, bx1, by1;
+
+	a.box(ax0, ay0, ax1, ay1);
+	b.box(bx0, by0, bx1, by1);
+
+	return ax0 <= bx1 + tolerance && bx0 <= ax1 + tolerance
+		&& ay0 <= by1 + tolerance && by0 <= ay1 + tolerance;
+}
+
+/// Calcule l'intervalle [lo, hi] des parametres locaux de a pouvant couper
+/// la bande (fat line) qui enveloppe b. La distance de a a l'axe de la
+/// bande est une courbe de Bezier de points de controle (i/3, d_i): son
+/// enveloppe convexe coupe la bande sur un intervalle contenant toutes
+/// les solutions. Les bords de cet intervalle sont sur les cotes de
+/// l'enveloppe, qui sont parmi les segments joignant deux points de
+/// controle. Retourne false si l'intervalle est vide.
+bool clip(const Segment &a, const Segment &b, real tolerance, real &lo, real &hi)
+{
+	auto axis = b.p[3] - b.p[0];
+	auto length = std::sqrt(SQUARE(axis.x) + SQUARE(axis.y));
+
+	lo = 0;
+	hi = 1;
+	if (length <= tolerance) {
+		// Portion fermee sur elle-meme: pas d'axe, a est laisse entier.
+		return true;
+	}
+
+	auto distance = [&](const Point &p) {
+		return (axis.x*(p.y - b.p[0].y) - axis.y*(p.x - b.p[0].x))/length;
+	};
+
+	auto d1 = distance(b.p[1]), d2 = distance(b.p[2]);
+	auto k = d1*d2 > 0 ? real(3)/4 : real(4)/9;
+	auto dmin = k*std::min(std::min(d1, d2), real(0)) - tolerance/2;
+	auto dmax = k*std::max(std::max(d1, d2), real(0)) + tolerance/2;
+
+	const real xs[] = {0, real(1)/3, real(2)/3, 1};
+	real ds[4];
+	for (unsigned int i = 0; i < 4; ++i) {
+		ds[i] = distance(a.p[i]);
+	}
+
+	lo = std::numeric_limits<real>::infinity();
+	hi = -lo;
+	auto include = [&](real x) {
+		lo = std::min(lo, x);
+		hi = std::max(hi, x);
+	};
+
+	for (unsigned int i = 0; i < 4; ++i) {
+		if (ds[i] >= dmin && ds[i] <= dmax) {
+			include(xs[i]);
+		}
+		for (unsigned int j = i + 1; j < 4; ++j) {
+			for (auto bound: {dmin, dmax}) {
+				if ((ds[i] - bound)*(ds[j] - bound) < 0) {
+					include(xs[i] + (bound - ds[i])/(ds[j] - ds[i])*(xs[j] - xs[i]));
+				}
+			}
+		}
+	}
+
+	if (lo > hi) return false;
+
+	lo = std::max(lo, real(0));
+	hi = std::min(hi, real(1));
+	return true;
+}
+
+/// Recherche les intersections de a et b. swapped indique que les roles
+/// des courbes d'origine sont echanges.
+void search(
+	const Segment &a, const Segment &b, bool swapped, unsigned int depth,
+	real tolerance, unsigned int &steps, std::vector<Intersection> &out)
+{
+	if (steps == 0 || ! overlap(a, b, tolerance)) return;
+	--steps;
+
+	auto aSmall = a.extent() <= tolerance, bSmall = b.extent() <= tolerance;
+
+	if ((aSmall && bSmall) || depth >= MaxDepth) {
+		auto t = (a.t0 + a.t1)/2, u = (b.t0 + b.t1)/2;
+		out.push_back(swapped ? Intersection{u, t, false} : Intersection{t, u, false});
+		return;
+	}
+
+	real lo = 0, hi = 1;
+	if (! aSmall && ! clip(a, b, tolerance, lo, hi)) return;
+
+	if (hi - lo > MaxClipRatio) {
+		// Decoupage inefficace: la plus grande portion est coupee en deux.
+		if (a.extent() >= b.extent()) {
+			Segment left, right;
+			a.halve(left, right);
+			search(b, left, ! swapped, depth + 1, tolerance, steps, out);
+			search(b, right, ! swapped, depth + 1, tolerance, steps, out);
+		} else {
+			Segment left, right;
+			b.halve(left, right);
+			search(left, a, ! swapped, depth + 1, tolerance, steps, out);
+			search(right, a, ! swapped, depth + 1, tolerance, steps, out);
+		}
+		return;
+	}
+
+	search(b, a.sub(lo, hi), ! swapped, depth + 1, tolerance, steps, out);
+}
+
+/// Une meme intersection peut etre trouvee dans plusieurs portions
+/// voisines (bord commun, courbes tangentes ou confondues). Les points
+/// consecutifs (par t croissant) distants sur curve de moins de quelques
+/// tolerances et de parametres u voisins forment une grappe, dont seul le
+/// point median est conserve.
+void search(
+	const Segment &a, const Segment &b, const Bezier &curve,
+	real tolerance, std::vector<Intersection> &out)
+{
+	auto first = out.size();
+	auto steps = MaxSearchSteps;
+
+	search(a, b, false, 0, tolerance, steps, out);
+
+	auto begin = out.begin() + first, end = out.end();
+	std::sort(begin, end, [](const Intersection &l, const Intersection &r) {
+		return l.t < r.t;
+	});
+
+	auto near = [&](const Intersection &l, const Intersection &r) {
+		auto d = curve(r.t) - curve(l.t);
+		return std::max(std::fabs(d.x), std::fabs(d.y)) <= 4*tolerance
+			&& std::fabs(r.u - l.u) <= real(.01);
+	};
+
+	auto kept = begin;
+	for (auto i = begin; i != end;) {
+		auto j = i + 1;
+		while (j != end && near(*(j - 1), *j)) ++j;
+		*kept++ = *(i + (j - i)/2);
+		i = j;
+	}
+	out.erase(kept, end);
+}
+
+bool overlap(const Rect &a, const Rect &b, real tolerance)
+{
+	return a.topLeft().x <= b.bottomRight().x + tolerance
+		&& b.topLeft().x <= a.bottomRight().x + tolerance
+		&& a.topLeft().y <= b.bottomRight().y + tolerance
+		&& b.topLeft().y <= a.bottomRight().y + tolerance;
+}
+
+bool within(const Point &p, const Rect &box, real tolerance)
+{
+	return p.x >= box.topLeft().x - tolerance && p.x <= box.bottomRight().x + tolerance
+		&& p.y >= box.topLeft().y - tolerance && p.y <= box.bottomRight().y + tolerance;
+}
+
+/// Cherche une partie commune aux courbes a et b. Ses extremites sont
+/// parmi celles des deux courbes: chaque extremite d'une courbe situee a
+/// moins de tolerance de l'autre donne un couple de parametres (t, u). Si
+/// les couples extremes sont distincts, la portion de a qui les separe
+/// doit encore rester a moins de tolerance de b en quelques points
+/// interieurs. first et last recoivent les extremites, par t croissant.
+bool coincide(
+	const Bezier &a, const Bezier &b, real tolerance,
+	Intersection &first, Intersection &last)
+{
+	auto boxA = a.controlBox(), boxB = b.controlBox();
+	Intersection found[4];
+	unsigned int count = 0;
+
+	auto addA = [&](real t, const Point &p) {
+		if (! within(p, boxB, tolerance)) return;
+		auto projection = b.project(p);
+		if (projection.distance <= tolerance) {
+			found[count++] = {t, projection.t, true};
+		}
+	};
+	auto addB = [&](real u, const Point &p) {
+		if (! within(p, boxA, tolerance)) return;
+		auto projection = a.project(p);
+		if (projection.distance <= tolerance) {
+			found[count++] = {projection.t, u, true};
+		}
+	};
+
+	addA(0, a.p1());
+	addA(1, a.p2());
+	addB(0, b.p1());
+	addB(1, b.p2());
+	if (count < 2) return false;
+
+	auto order = [](const Intersection &l, const Intersection &r) {
+		return l.t < r.t;
+	};
+	first = *std::min_element(found, found + count, order);
+	last = *std::max_element(found, found + count, order);
+
+	auto d = a(last.t) - a(first.t);
+	if (std::max(std::fabs(d.x), std::fabs(d.y)) <= 4*tolerance) return false;
+
+	for (unsigned int i = 1; i < OverlapSamples; ++i) {
+		auto t = first.t + (last.t - first.t)*i/OverlapSamples;
+		if (b.project(a(t)).distance > tolerance) return false;
+	}
+	return true;
+}
+
+/// Ajoute a out les intersections de a et b (voir intersect()).
+void intersections(
+	const Bezier &a, const Bezier &b, real tolerance, std::vector<Intersection> &out)
+{
+	Intersection first, last;
+
+	if (coincide(a, b, tolerance, first, last)) {
+		out.push_back(first);
+		out.push_back(last);
+		return;
+	}
+	search(Segment::of(a), Segment::of(b), a, tolerance, out);
+}
+}
+
+void nealrame::intersect(
+	const Bezier &a, const Bezier &b, std::vector<Intersection> &out,
+	real tolerance)
+{
+	if (! overlap(a.boudingBox(), b.boudingBox(), tolerance)) return;
+
+	intersections(a, b, tolerance, out);
+}
+
+/// La distance signee de la courbe a la droite (p0, p1), multipliee par
+/// |p1 - p0|, est une cubique en t dont les racines dans [0, 1] sont
+/// calculees directement; u est la projection du point sur le segment.
+/// Un segment de longueur inferieure a la tolerance est traite comme une
+/// cubique aux points de controle places aux tiers.
+void nealrame::intersect(
+	const Bezier &c, const Point &p0, const Point &p1, std::vector<Intersection> &out,
+	real tolerance)
+{
+	if (! overlap(c.boudingBox(), Rect(p0, p1), tolerance)) return;
+
+	auto d = p1 - p0;
+	auto length2 = SQUARE(d.x) + SQUARE(d.y);
+
+	if (length2 <= SQUARE(tolerance)) {
+		Segment line = {{p0, p0 + d*(real(1)/3), p0 + d*(real(2)/3), p1}, 0, 1};
+		search(Segment::of(c), line, c, tolerance, out);
+		return;
+	}
+
+	const real xs[] = {c.p1().x - p0.x, c.ctrl1().x - p0.x, c.ctrl2().x - p0.x, c.p2().x - p0.x};
+	const real ys[] = {c.p1().y - p0.y, c.ctrl1().y - p0.y, c.ctrl2().y - p0.y, c.p2().y - p0.y};
+	auto x = BezierN<3>::component(xs), y = BezierN<3>::component(ys);
+
+	Bezier::Polynomial distance;
+	for (unsigned int i = 0; i <= 3; ++i) {
+		distance[i] = d.x*y[i] - d.y*x[i];
+	}
+
+	real ts[3];
+	auto slack = tolerance/std::sqrt(length2);
+
+	for (unsigned int i = 0, count = distance.roots(0, 1, ts); i < count; ++i) {
+		auto u = (d.x*x(ts[i]) + d.y*y(ts[i]))/length2;
+		if (u >= -slack && u <= 1 + slack) {
+			out.push_back({ts[i], std::min(std::max(u, real(0)), real(1)), false});
+		}
+	}
+}
+
+void nealrame::intersect(
+	const CurveBatch &curves, std::vector<CurveIntersection> &out,
+	real tolerance)
+{
+	auto count = curves.size();
+	auto boxes = curves.boundingBoxes();
+	SpatialIndex index(0);
+	std::vector<Intersection> points;
+
+	for (CurveBatch::size_type i = 0; i < count; ++i) {
+		index.insert(i, boxes[i]);
+	}
+
+	auto expand = Point{tolerance, tolerance};
+
+	for (CurveBatch::size_type i = 0; i < count; ++i) {
+		auto a = curves[i];
+
+		index.query(
+			Rect(boxes[i].topLeft() - expand, boxes[i].bottomRight() + expand),
+			[&](SpatialIndex::Id j) {
+				if (j <= i) return;
+
+				points.clear();
+				intersections(a, curves[j], tolerance, points);
+				for (auto &p: points) {
+					out.push_back({i, j, p.t, p.u, p.overlap});
+				}
+			}
+		);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common.h"
+#include "curvebatch.h"
+#include "point.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace nealrame
+{
+class Bezier;
+
+/// Precision par defaut, en pixels, des points d'intersection.
+const real IntersectionTolerance = 1e-3f;
+
+/// Point d'intersection de deux courbes: parametre t sur la premiere et u
+/// sur la seconde (pour un segment [p0, p1], le point est p0 + u*(p1 - p0)).
+/// overlap indique une extremite d'une partie commune aux deux courbes.
+struct Intersection {
+	real t, u;
+	bool overlap;
+};
+
+/// Point d'intersection des courbes d'indices first < second d'un lot.
+struct CurveIntersection {
+	CurveBatch::size_type first, second;
+	real t, u;
+	bool overlap;
+};
+
+/// Ajoute a out les intersections des courbes a et b, classees par t
+/// croissant.
+///
+/// Les courbes dont les boites englobantes (Bezier::boudingBox()) sont
+/// disjointes sont ecartees d'emblee. Sinon, l'intersection est cherchee
+/// par decoupage de Bezier (fat line clipping, Sederberg et Nishita): la
+/// portion d'une courbe qui peut couper la bande enveloppant l'autre est
+/// isolee par l'enveloppe convexe de sa distance a la bande, puis les
+/// roles sont echanges. Lorsqu'une etape reduit trop peu l'intervalle
+/// (intersections multiples, courbes presque tangentes), la plus grande
+/// des deux courbes est coupee en deux. Une intersection est retenue
+/// lorsque les deux portions tiennent dans un carre de cote tolerance.
+///
+/// Les points trouves a moins de quelques tolerances les uns des autres
+/// sont fusionnes: un point de tangence ne donne qu'une intersection. Le
+/// nombre d'etapes de la recherche est borne (MaxSearchSteps).
+///
+/// Une partie commune aux deux courbes (courbes confondues sur un
+/// intervalle) est detectee avant la recherche: elle est rapportee par ses
+/// deux extremites, marquees overlap, et aucune autre intersection n'est
+/// cherchee.
+void intersect(
+	const Bezier &a, const Bezier &b, std::vector<Intersection> &out,
+	real tolerance = IntersectionTolerance);
+
+/// Ajoute a out les intersections de la courbe et du segment [p0, p1].
+void intersect(
+	const Bezier &, const Point &p0, const Point &p1, std::vector<Intersection> &out,
+	real tolerance = IntersectionTolerance);
+
+/// Ajoute a out les intersections de toutes les paires de courbes du lot.
+/// Les boites englobantes des courbes sont rangees dans un SpatialIndex:
+/// seules les paires dont les boites se chevauchent sont examinees. Les
+/// extremites communes de courbes consecutives sont des intersections
+/// comme les autres.
+void intersect(
+	const CurveBatch &, std::vector<CurveIntersection> &out,
+	real tolerance = IntersectionTolerance);
+}
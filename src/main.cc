@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <exception>
 #include <functional>
@@ -14,15 +15,20 @@
 #include "color.h"
 #include "context.h"
 #include "error.h"
+#include "framescheduler.h"
 #include "point.h"
 #include "rect.h"
 #include "painter.h"
+#include "scene.h"
 #include "window.h"
 
 using namespace nealrame;
 
+/// Parenthese tracee comme un trait plein dont l'epaisseur, nulle aux
+/// extremites, atteint weight en son milieu.
 class Parenthesis {
-	Bezier extern_, intern_;
+	Bezier curve_;
+	StrokeStyle style_;
 public:
 	enum Type {
 		Opening, Closing
@@ -50,36 +56,32 @@ public:
 		
 		auto A = Point{B.x - (C.x - B.x)/3, B.y};
 		auto d = std::fabs(p2.y - p1.y)*ratio;
-		auto c1 = Point{A.x, p1.y + d};
-		auto c2 = Point{A.x, p2.y - d};
+		auto c1 = Point{A.x + weight/2, p1.y + d};
+		auto c2 = Point{A.x + weight/2, p2.y - d};
 
-		extern_ = Bezier(p1, c1, c2, p2);
-		intern_ = Bezier(p1, {c1.x + weight, c1.y},{c2.x + weight, c2.y}, p2);
+		curve_ = Bezier(p1, c1, c2, p2);
+		style_ = StrokeStyle(
+			WidthProfile(0, 2*std::fabs(weight), 0),
+			LineJoin::Round, LineCap::Round
+		);
 	}
 
-	bool draw(Painter &painter)
-	{
-		painter.setDrawColor(Color{0x00, 0xff, 0x00});
-		painter.drawCurve(extern_);
-		painter.drawCurve(intern_);
-		// painter.drawPoint(p1);
-		// painter.drawPoint(p2);
-		// painter.setDrawColor({0xff, 0x00, 0x00});
-		// painter.drawPoint(A);
-		// painter.drawPoint(B);
-		// painter.drawPoint(C);
-		return true;
-	}
+	const Bezier & curve() const
+	{ return curve_; }
+
+	const StrokeStyle & style() const
+	{ return style_; }
 };
 
-template<unsigned int N>
-Point * select(std::array<Point, N> &points, Point p) {
-	auto end = points.end();
-	auto it = std::find_if(points.begin(), end, [&](Point &point) {
-		auto d = std::sqrt(SQUARE(point.x - p.x) + SQUARE(point.y - p.y));
-		return d <= 5;
-	});
-	return it != end ? &(*it) : nullptr;
+/// Melange les couleurs a et b: a pour k = 0, b pour k = 1.
+static Color mix(const Color &a, const Color &b, real k)
+{
+	return Color(
+		a.red + (b.red - a.red)*k,
+		a.green + (b.green - a.green)*k,
+		a.blue + (b.blue - a.blue)*k,
+		a.alpha + (b.alpha - a.alpha)*k
+	);
 }
 
 int main(int argc, char **argv) {
@@ -89,14 +91,34 @@ int main(int argc, char **argv) {
 
 		bool cont = true;
 		bool drag = false;
-		Point p1, p2;
+		Point p1 = {0, 0}, p2 = {0, 0};
 
 		auto box = Rect({128, 64}, {256, 340});
+		auto parenthesis = Parenthesis(box, Parenthesis::Closing, 8., 1./4);
+
+		Scene scene(Color::Black);
+		scene.setTessellationCache(std::make_shared<TessellationCache>());
+		scene.setViewport(Rect({0, 0}, window->size().width, window->size().height));
+
+		auto selection = scene.addRect(Rect(p1, p2), Color::White);
+		auto stroke = scene.addStroke(parenthesis.curve(), parenthesis.style(), Color::Green);
+
+		// La mise en evidence de la parenthese sous le pointeur est
+		// animee: glow passe progressivement de 0 (vert) a 1 (rouge).
+		const auto fadeDuration = std::chrono::milliseconds(150);
+		FrameScheduler frames;
+		FrameScheduler::Clock::time_point fadeStart;
+		bool hover = false;
+		real glow = 0, fadeFrom = 0;
 
 		auto on_quit = [&](const Window::EventData &){cont = false;};
 
 		window->on(SDL_QUIT, on_quit);
 		window->on(SDL_KEYDOWN, on_quit);
+		window->on(
+			SDL_WINDOWEVENT,
+			[&](const Window::EventData &){ scene.invalidate(); }
+		);
 
 		window->on(
 			SDL_MOUSEBUTTONDOWN, 
@@ -106,6 +128,7 @@ int main(int argc, char **argv) {
 					float(data.button.x),
 					float(data.button.y)
 				};
+				scene.setRect(selection, Rect(p1, p2));
 			}
 		);
 
@@ -114,75 +137,53 @@ int main(int argc, char **argv) {
 			[&](const Window::EventData &data){
 				drag = false;
 				box = {p1, p2};
+				parenthesis = Parenthesis(box, Parenthesis::Closing, 8., 1./4);
+				scene.setCurve(stroke, parenthesis.curve());
 			}
 		);
 
 		window->on(
 			SDL_MOUSEMOTION,
 			[&](const Window::EventData &data){
-				if (! drag) return;
+				if (! drag) {
+					// Met en evidence la parenthese sous le pointeur.
+					Scene::NodeId node;
+					auto over = scene.pick(
+						{float(data.motion.x), float(data.motion.y)}, 5, node
+					) && node == stroke;
+					if (over != hover) {
+						hover = over;
+						fadeFrom = glow;
+						fadeStart = FrameScheduler::Clock::now();
+						frames.animate(fadeDuration);
+					}
+					return;
+				}
 				p2 = {
 					float(data.motion.x), 
 					float(data.motion.y)
 				};
+				scene.setRect(selection, Rect(p1, p2));
 			}
 		);
 
+		// Hors animation, la boucle dort jusqu'au prochain evenement; rien
+		// n'est dessine tant que la scene n'a pas change.
 		do {
-			window->pollEvent();
-
-			painter->setDrawColor({0, 0, 0});
-			painter->clear();
-
-			painter->setDrawColor({ 0xff, 0xff, 0xff });
-			painter->drawRect(Rect(p1, p2));
-
-			// painter->setDrawColor({ 0x00, 0xff, 0x00 });
-			// painter->drawLine(t1, t2);
-
-			// painter->setDrawColor({ 0xff, 0x00, 0x00 });
-
-			// painter->drawPoint(p1);
-			// painter->drawPoint(p2);
-
-			// painter->drawPoint(A);
-			// painter->drawPoint(B);
-			// painter->drawPoint(C);
-
-			// // painter->drawPoint(t1);
-			// // painter->drawPoint(t2);
-
-			// painter->drawPoint(c1);
-			// painter->drawPoint(c2);
-
-			// Bezier curve(p1, c1, c2, p2);
-
-			Parenthesis parenthesis(box, Parenthesis::Closing, 8., 1./4);
-
-			painter->setDrawColor({ 0x00, 0xff, 0x00 });
-			parenthesis.draw(*painter);
-
-			// painter->drawCurve(Bezier::fromBoundingBox(box, 1./4));
-
-			// painter->setDrawColor({ 0xff, 0x00, 0x00 });
-			// painter->drawCurve(Bezier::fromBoundingBox(box, 1./8));
-
-			// painter->setDrawColor({ 0x00, 0x00, 0xff });
-			// painter->drawCurve(Bezier::fromBoundingBox(box, 1./4));
-
-			// painter->setDrawColor({ 0xff, 0x00, 0x00 });
-			// painter->drawPoint(points[0]);
-			// painter->drawPoint(points[1]);
-			// painter->drawPoint(points[2]);
-			// painter->drawPoint(points[3]);
-
-			// painter->setDrawColor({ 0x00, 0xff, 0x00 });
-			// painter->drawRect(curve.boudingBox());
-
-
-
+			window->waitEvent(frames.timeout());
+
+			if (frames.frameDue()) {
+				auto elapsed = std::chrono::duration<real, std::milli>(
+					FrameScheduler::Clock::now() - fadeStart
+				);
+				auto progress = std::min(real(1), elapsed.count()/fadeDuration.count());
+				glow = fadeFrom + ((hover ? 1 : 0) - fadeFrom)*progress;
+				scene.setColor(stroke, mix(Color::Green, Color::Red, glow));
+			}
 
-			painter->present();
+			if (scene.render(*painter)) {
+				painter->present();
+			}
 		} while (cont);
 
 		return 0;
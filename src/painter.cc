@@ -1,37 +1,43 @@
+#include "backend.h"
 #include "bezier.h"
 #include "color.h"
+#include "curvebatch.h"
 #include "error.h"
+#include "flatten.h"
 #include "painter.h"
+#include "path.h"
 #include "point.h"
+#include "rasterizer.h"
 #include "rect.h"
-#include "window.h"
+#include "stroker.h"
+#include "transform.h"
 
-#include <functional>
+#include <cmath>
 
-#include <SDL.h>
+#include <vector>
 
 using namespace nealrame;
 
 struct Painter::Impl {
-	Impl(std::shared_ptr<Window> window, SDL_Renderer *renderer) :
-		window(window),
-		renderer(renderer, SDL_DestroyRenderer)
+	Impl(std::shared_ptr<Backend> backend) :
+		backend(backend)
 	{ }
-	std::shared_ptr<Window> window;
-	std::unique_ptr<SDL_Renderer, std::function<void(SDL_Renderer *)>> renderer;
+	std::shared_ptr<Backend> backend;
+	Transform transform;
+	std::vector<Transform> stack;
+	Polyline polyline;
+	Polyline mapped;
+	std::vector<Bezier> curves;
+	std::vector<Polyline> contours;
+	Path path;
+	EdgeList edges;
 };
 
-Painter::Painter(std::shared_ptr<Window> window) :
-	d_(new Impl(
-		window,
-		SDL_CreateRenderer(
-			static_cast<SDL_Window *>(window->get()), -1,
-			SDL_RENDERER_ACCELERATED|SDL_RENDERER_PRESENTVSYNC
-		)
-	))
-{
-	if (! d_->renderer) {
-		throw Error(SDL_GetError());
+Painter::Painter(std::shared_ptr<Backend> backend) :
+	d_(new Impl(backend))
+{
+	if (! d_->backend) {
+		throw Error("Painter: no backend");
 	}
 }
 
@@ -49,36 +55,120 @@ Painter & Painter::operator=(Painter &&rhs)
 	return *this;
 }
 
+std::shared_ptr<Backend> Painter::backend() const
+{
+	return d_->backend;
+}
+
 bool Painter::clear()
 {
-	return SDL_RenderClear(d_->renderer.get()) >= 0;
+	return d_->backend->clear();
 }
 
 bool Painter::setDrawColor(const Color &c)
 {
-	return SDL_SetRenderDrawColor(
-		d_->renderer.get(), c.red, c.green, c.blue, c.alpha
-	) >= 0;
+	return d_->backend->setDrawColor(c);
+}
+
+bool Painter::setLineWidth(real width)
+{
+	return d_->backend->setLineWidth(width);
+}
+
+const Transform & Painter::transform() const
+{
+	return d_->transform;
+}
+
+void Painter::setTransform(const Transform &t)
+{
+	d_->transform = t;
+}
+
+void Painter::apply(const Transform &t)
+{
+	d_->transform = d_->transform*t;
+}
+
+void Painter::translate(real x, real y)
+{
+	apply(Transform::translation(x, y));
+}
+
+void Painter::scale(real sx, real sy)
+{
+	apply(Transform::scaling(sx, sy));
+}
+
+void Painter::rotate(real angle)
+{
+	apply(Transform::rotation(angle));
+}
+
+void Painter::save()
+{
+	d_->stack.push_back(d_->transform);
+}
+
+void Painter::restore()
+{
+	if (d_->stack.empty()) {
+		throw Error("Painter: restore without save");
+	}
+	d_->transform = d_->stack.back();
+	d_->stack.pop_back();
 }
 
-bool Painter::drawPoint(const Point &p1) {
-	return drawRect({{p1.x - 2, p1.y - 2}, {p1.x + 2, p1.y + 2}});
+/// Le point est transforme, pas le marqueur: il garde sa taille a l'ecran.
+bool Painter::drawPoint(const Point &p) {
+	auto p1 = d_->transform(p);
+	return d_->backend->drawRect({{p1.x - 2, p1.y - 2}, {p1.x + 2, p1.y + 2}});
 }
 
 bool Painter::drawLine(const Point &p1, const Point &p2) {
-	return SDL_RenderDrawLine(
-		d_->renderer.get(), p1.x, p1.y, p2.x, p2.y
-	) >= 0;
+	auto &polyline = d_->polyline;
+
+	polyline.clear();
+	polyline.push_back(p1);
+	polyline.push_back(p2);
+
+	return drawPolyline(polyline);
 }
 
-bool Painter::drawCurve(const Bezier &c)
+/// Une translation ne fait que deplacer l'origine de la ligne brisee;
+/// toute autre transformation est appliquee a chacun de ses points.
+bool Painter::drawPolyline(const Polyline &polyline, const Point &offset)
 {
-	float t = 0;
-	do {
-		if (! drawLine(c(t), c(t + 0.05))) {
-			return false;
-		}
-	} while ((t += 0.05) <= 1);
+	auto &t = d_->transform;
+
+	if (t.isTranslation()) {
+		return d_->backend->drawPolyline(polyline, offset + t.offset());
+	}
+
+	auto &mapped = d_->mapped;
+
+	mapped.clear();
+	for (auto &p: polyline) {
+		mapped.push_back(t(p + offset));
+	}
+	return d_->backend->drawPolyline(mapped, Point{0, 0});
+}
+
+bool Painter::drawCurve(const Bezier &c, real tolerance)
+{
+	auto &polyline = d_->polyline;
+	auto &t = d_->transform;
+
+	polyline.clear();
+	if (t.isIdentity()) {
+		flatten(c, polyline, tolerance);
+	} else {
+		flatten(t(c), polyline, tolerance);
+	}
+
+	if (! d_->backend->drawPolyline(polyline, Point{0, 0})) {
+		return false;
+	}
 
 	// drawPoint(c.p1());
 	// drawPoint(c.p2());
@@ -89,18 +179,96 @@ bool Painter::drawCurve(const Bezier &c)
 	return true;
 }
 
+bool Painter::drawCurves(const CurveBatch &batch, real tolerance)
+{
+	auto &polyline = d_->polyline;
+	auto &t = d_->transform;
+
+	for (CurveBatch::size_type i = 0, count = batch.size(); i < count; ++i) {
+		polyline.clear();
+		if (t.isIdentity()) {
+			batch.flatten(i, polyline, tolerance);
+		} else {
+			flatten(t(batch[i]), polyline, tolerance);
+		}
+		if (! d_->backend->drawPolyline(polyline, Point{0, 0})) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Un rectangle tourne ou cisaille est dessine comme un contour ferme.
 bool Painter::drawRect(const Rect &r)
 {
-	SDL_Rect rect = { 
-		int16_t(r.topLeft().x),
-		int16_t(r.topLeft().y),
-		int16_t(r.width()),
-		int16_t(r.height())
-	};
-	return SDL_RenderDrawRect(d_->renderer.get(), &rect);
+	auto &t = d_->transform;
+
+	if (t.isAxisAligned()) {
+		return d_->backend->drawRect(t(r));
+	}
+
+	auto &polyline = d_->polyline;
+
+	polyline.clear();
+	for (auto &p: {r.topLeft(), r.topRight(), r.bottomRight(), r.bottomLeft(), r.topLeft()}) {
+		polyline.push_back(t(p));
+	}
+	return d_->backend->drawPolyline(polyline, Point{0, 0});
+}
+
+bool Painter::strokeCurve(const Bezier &curve, const StrokeStyle &style, real tolerance)
+{
+	return strokeCurves(&curve, 1, style, false, tolerance);
+}
+
+bool Painter::strokeCurves(
+	const Bezier *curves, std::size_t count, const StrokeStyle &style,
+	bool closed, real tolerance)
+{
+	auto &edges = d_->edges;
+	auto &t = d_->transform;
+
+	edges.clear();
+	if (t.isIdentity()) {
+		Stroker(edges, tolerance).stroke(curves, count, style, closed);
+	} else {
+		// L'epaisseur est multipliee par le facteur d'echelle moyen: sous
+		// une mise a l'echelle non uniforme, le trait reste d'epaisseur
+		// uniforme.
+		auto &mapped = d_->curves;
+		auto k = std::sqrt(std::fabs(t.determinant()));
+		auto scaled = style;
+
+		mapped.clear();
+		for (std::size_t i = 0; i < count; ++i) {
+			mapped.push_back(t(curves[i]));
+		}
+		scaled.width = WidthProfile(k*style.width.start, k*style.width.middle, k*style.width.end);
+		Stroker(edges, tolerance).stroke(mapped.data(), count, scaled, closed);
+	}
+
+	return d_->backend->fill(edges, FillRule::NonZero);
+}
+
+bool Painter::fillPath(const Path &path, FillRule rule, real tolerance)
+{
+	auto &contours = d_->contours;
+	auto &t = d_->transform;
+
+	contours.clear();
+	if (t.isIdentity()) {
+		path.flatten(contours, tolerance);
+	} else {
+		auto &mapped = d_->path;
+		mapped = path;
+		mapped.transform(t);
+		mapped.flatten(contours, tolerance);
+	}
+
+	return d_->backend->fill(contours, rule);
 }
 
 void Painter::present()
 {
-	SDL_RenderPresent(d_->renderer.get());
+	d_->backend->present();
 }
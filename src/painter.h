@@ -1,6 +1,10 @@
 #pragma once
 
 #include "common.h"
+#include "flatten.h"
+#include "path.h"
+#include "stroker.h"
+#include "transform.h"
 
 namespace nealrame
 {
@@ -8,7 +12,8 @@ struct Color;
 struct Point;
 class Rect;
 class Bezier;
-class Window;
+class CurveBatch;
+class Backend;
 class Painter {
 	PIMPL;
 
@@ -16,19 +21,60 @@ class Painter {
 	Painter & operator=(const Painter &) = delete;
 
 public:
-	Painter(std::shared_ptr<Window> win);
+	Painter(std::shared_ptr<Backend> backend);
 	Painter(Painter &&rhs);
 	virtual ~Painter();
 
 	Painter & operator=(Painter &&rhs);
 
+	std::shared_ptr<Backend> backend() const;
+
 public:
 	bool clear();
 	bool setDrawColor(const Color &);
+	bool setLineWidth(real width);
+
+	/// Transformation courante, appliquee a tout ce qui est dessine. Les
+	/// courbes sont transformees par leurs points de controle, puis
+	/// approchees dans l'espace de l'affichage: les tolerances restent
+	/// exprimees en pixels quel que soit le facteur d'echelle, et le cout
+	/// d'un changement de vue ne depend que du nombre de courbes.
+	const Transform & transform() const;
+	void setTransform(const Transform &);
+
+	/// Compose la transformation courante avec t, qui s'applique en
+	/// premier aux points dessines.
+	void apply(const Transform &t);
+	void translate(real x, real y);
+	void scale(real sx, real sy);
+	void rotate(real angle);
+
+	/// Empile la transformation courante; restore() la retablit. Leve une
+	/// Error si la pile est vide.
+	void save();
+	void restore();
+
 	bool drawPoint(const Point &);
 	bool drawLine(const Point &, const Point &);
-	bool drawCurve(const Bezier &);
+	bool drawPolyline(const Polyline &, const Point &offset = Point{0, 0});
+	bool drawCurve(const Bezier &, real tolerance = DefaultTolerance);
+	bool drawCurves(const CurveBatch &, real tolerance = DefaultTolerance);
 	bool drawRect(const Rect &);
+
+	/// Remplit le contour du trait de la courbe (voir Stroker).
+	bool strokeCurve(
+		const Bezier &, const StrokeStyle &,
+		real tolerance = DefaultTolerance);
+
+	/// Remplit, en une seule passe, le contour du trait de la suite de
+	/// count courbes.
+	bool strokeCurves(
+		const Bezier *, std::size_t count, const StrokeStyle &,
+		bool closed = false, real tolerance = DefaultTolerance);
+
+	bool fillPath(
+		const Path &, FillRule = FillRule::NonZero,
+		real tolerance = DefaultTolerance);
 	void present();
 };
 }
@@ -0,0 +1,105 @@
+#include "path.h"
+
+#include "bezier.h"
+#include "transform.h"
+
+using namespace nealrame;
+
+void Path::moveTo(const Point &p)
+{
+	verbs_.push_back(Move);
+	points_.push_back(p);
+}
+
+void Path::lineTo(const Point &p)
+{
+	if (verbs_.empty()) {
+		moveTo(p);
+		return;
+	}
+	verbs_.push_back(Line);
+	points_.push_back(p);
+}
+
+void Path::curveTo(const Point &ctrl1, const Point &ctrl2, const Point &p)
+{
+	if (verbs_.empty()) {
+		moveTo(ctrl1);
+	}
+	verbs_.push_back(Curve);
+	points_.push_back(ctrl1);
+	points_.push_back(ctrl2);
+	points_.push_back(p);
+}
+
+void Path::add(const Bezier &c)
+{
+	if (verbs_.empty() || verbs_.back() == Close || points_.back() != c.p1()) {
+		moveTo(c.p1());
+	}
+	curveTo(c.ctrl1(), c.ctrl2(), c.p2());
+}
+
+void Path::close()
+{
+	if (! verbs_.empty() && verbs_.back() != Close) {
+		verbs_.push_back(Close);
+	}
+}
+
+void Path::clear()
+{
+	verbs_.clear();
+	points_.clear();
+}
+
+bool Path::empty() const
+{
+	return verbs_.empty();
+}
+
+void Path::transform(const Transform &t)
+{
+	for (auto &p: points_) {
+		p = t(p);
+	}
+}
+
+void Path::flatten(std::vector<Polyline> &contours, real tolerance) const
+{
+	auto point = points_.begin();
+	auto start = Point{0, 0};
+	Polyline *contour = nullptr;
+
+	for (auto verb: verbs_) {
+		// Apres une fermeture, le contour suivant repart du point de depart
+		// du precedent.
+		if (! contour && verb != Move) {
+			contours.emplace_back(1, start);
+			contour = &contours.back();
+		}
+
+		switch (verb) {
+		case Move:
+			start = *point++;
+			contours.emplace_back(1, start);
+			contour = &contours.back();
+			break;
+
+		case Line:
+			contour->push_back(*point++);
+			break;
+
+		case Curve: {
+			auto p0 = contour->back();
+			contour->pop_back();
+			nealrame::flatten(Bezier(p0, point[0], point[1], point[2]), *contour, tolerance);
+			point += 3;
+		} break;
+
+		case Close:
+			contour = nullptr;
+			break;
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "common.h"
+#include "flatten.h"
+#include "point.h"
+
+#include <vector>
+
+namespace nealrame
+{
+class Bezier;
+class Transform;
+
+/// Regle de remplissage d'un chemin.
+enum class FillRule {
+	NonZero, EvenOdd
+};
+
+/// Chemin compose de contours de segments et de courbes de Bezier
+/// cubiques. Les contours sont implicitement fermes lors du remplissage.
+class Path {
+public:
+	void moveTo(const Point &);
+	void lineTo(const Point &);
+	void curveTo(const Point &ctrl1, const Point &ctrl2, const Point &p);
+
+	/// Ajoute la courbe au contour courant. Si le contour ne se termine pas
+	/// au point de depart de la courbe, un nouveau contour est commence.
+	void add(const Bezier &);
+
+	/// Ferme le contour courant.
+	void close();
+
+	void clear();
+	bool empty() const;
+
+	/// Applique la transformation a tous les points du chemin. Les courbes
+	/// etant invariantes par transformation affine, le chemin transforme
+	/// est exactement l'image du chemin.
+	void transform(const Transform &);
+
+	/// Approche chaque contour par une ligne brisee s'en ecartant d'au plus
+	/// tolerance. Les lignes brisees sont ajoutees a la fin de contours.
+	void flatten(std::vector<Polyline> &contours, real tolerance = DefaultTolerance) const;
+
+private:
+	enum Verb {
+		Move, Line, Curve, Close
+	};
+
+	std::vector<Verb> verbs_;
+	std::vector<Point> points_;
+};
+}
@@ -1,7 +1,13 @@
 #include "point.h"
 
+#include <type_traits>
+
+#include <boost/format.hpp>
+
 using namespace nealrame;
 
+static_assert(std::is_trivially_copyable<Point>::value, "Point must stay trivially copyable");
+
 Point & Point::translate(real x, real y)
 {
 	this->x += x; this->y += y;
@@ -23,7 +29,7 @@ Point Point::translated(const Point &p) const
 	return Point(*this).translate(p);
 }
 
-std::string Point::toString() const
+std::string Point::toString(const std::string &name) const
 {
 	return (boost::format("%1%(%2%,%3%)") % name % x % y).str();
 }
@@ -3,14 +3,15 @@
 #include "common.h"
 
 #include <string>
-#include <boost/format.hpp>
 
 namespace nealrame
 {
+/// Point du plan. Le type est trivialement copiable: il peut etre copie par
+/// memcpy et range dans des tableaux sans allocation. Pour nommer un point
+/// a l'affichage, passer le nom a toString().
 struct Point {
-	float x;
-	float y;
-	std::string name;
+	real x;
+	real y;
 
 	Point & translate(real x, real y);
 	Point & translate(const Point &p);
@@ -18,6 +19,30 @@ struct Point {
 	Point translated(real x, real y) const;
 	Point translated(const Point &p) const;
 
-	std::string toString() const;
+	std::string toString(const std::string &name = "") const;
 };
-}
\ No newline at end of file
+
+constexpr Point operator+(const Point &a, const Point &b)
+{ return {a.x + b.x, a.y + b.y}; }
+
+constexpr Point operator-(const Point &a, const Point &b)
+{ return {a.x - b.x, a.y - b.y}; }
+
+constexpr Point operator-(const Point &p)
+{ return {-p.x, -p.y}; }
+
+constexpr Point operator*(const Point &p, real k)
+{ return {p.x*k, p.y*k}; }
+
+constexpr Point operator*(real k, const Point &p)
+{ return {k*p.x, k*p.y}; }
+
+constexpr Point operator/(const Point &p, real k)
+{ return {p.x/k, p.y/k}; }
+
+constexpr bool operator==(const Point &a, const Point &b)
+{ return a.x == b.x && a.y == b.y; }
+
+constexpr bool operator!=(const Point &a, const Point &b)
+{ return ! (a == b); }
+}
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <limits>
 
 #include "common.h"
+#include "simd.h"
 
 namespace nealrame
 {
@@ -49,6 +52,13 @@ struct Polynomial {
 		return v;
 	}
 
+	/// Evalue le polynome pour chacune des count valeurs de xs et ecrit les
+	/// resultats dans out.
+	void evaluate(const real *xs, std::size_t count, real *out) const
+	{
+		simd::horner(factors, N, xs, count, out);
+	}
+
 	/// Retourne le coefficient du degre specifie
 	real & operator[](size_type i)
 	{
@@ -65,10 +75,251 @@ struct Polynomial {
 	Derived derived() const
 	{
 		real derived_factors[N];
-		for (int i = 1; i <= N; ++i) {
+		for (unsigned int i = 1; i <= N; ++i) {
 			derived_factors[i - 1] = i*factors[i];
 		}
 		return Derived(derived_factors);
 	}
+
+	/// Retourne la somme du polynome et de q.
+	Polynomial operator+(const Polynomial &q) const
+	{
+		Polynomial sum;
+		for (unsigned int i = 0; i <= N; ++i) {
+			sum[i] = factors[i] + q[i];
+		}
+		return sum;
+	}
+
+	/// Retourne le produit du polynome par q.
+	template <unsigned int M>
+	Polynomial<N + M> operator*(const Polynomial<M> &q) const
+	{
+		Polynomial<N + M> product;
+		for (unsigned int i = 0; i <= N; ++i) {
+			for (unsigned int j = 0; j <= M; ++j) {
+				product[i + j] += factors[i]*q[j];
+			}
+		}
+		return product;
+	}
+
+	/// Ecrit dans out (de taille N), par ordre croissant, les racines
+	/// reelles comprises dans [lo, hi] et retourne leur nombre.
+	///
+	/// Jusqu'au degre 3, les racines sont calculees par les formules
+	/// exactes: forme stable de la quadratique, forme trigonometrique de la
+	/// cubique a trois racines reelles, Cardan sinon. Au-dela, les racines
+	/// de la derivee (cherchees de la meme facon, au degre inferieur)
+	/// decoupent [lo, hi] en intervalles ou le polynome est monotone; chaque
+	/// changement de signe y est encadre et resolu par la methode de Newton
+	/// gardee par bissection. Aucune allocation n'est faite.
+	///
+	/// Un coefficient dominant nul abaisse le degre. Une racine double n'est
+	/// trouvee que si le polynome s'y annule aux erreurs d'arrondi pres.
+	unsigned int roots(real lo, real hi, real *out) const;
+
+	/// Indique si la valeur du polynome en x est nulle aux erreurs
+	/// d'arrondi de la methode de Horner pres. Le polynome nul n'a pas de
+	/// racine negligeable.
+	bool negligible(real x) const
+	{
+		real v = 0, bound = 0;
+		for (unsigned int i = 0; i <= N; ++i) {
+			v = v*x + factors[N - i];
+			bound = bound*std::fabs(x) + std::fabs(factors[N - i]);
+		}
+		return bound > 0 && std::fabs(v) <= std::numeric_limits<real>::epsilon()*bound;
+	}
 };
+
+namespace solver
+{
+/// Ajoute la racine x a out si elle appartient a [lo, hi]. Une racine
+/// hors de l'intervalle de quelques erreurs d'arrondi est ramenee a la
+/// borne la plus proche.
+inline void keep(double x, real lo, real hi, real *out, unsigned int &count)
+{
+	auto slack = 4*std::numeric_limits<real>::epsilon()*std::max(std::max(std::fabs(lo), std::fabs(hi)), real(1));
+
+	if (x >= lo - slack && x <= hi + slack) {
+		out[count++] = std::min(std::max(real(x), lo), hi);
+	}
+}
+
+/// Trie les count <= 3 valeurs de out.
+inline void sort(real *out, unsigned int count)
+{
+	if (count > 1 && out[0] > out[1]) std::swap(out[0], out[1]);
+	if (count > 2) {
+		if (out[1] > out[2]) std::swap(out[1], out[2]);
+		if (out[0] > out[1]) std::swap(out[0], out[1]);
+	}
+}
+
+/// Racine de a*x + b.
+inline unsigned int linear(double a, double b, real lo, real hi, real *out)
+{
+	unsigned int count = 0;
+	if (a != 0) {
+		keep(-b/a, lo, hi, out, count);
+	}
+	return count;
+}
+
+/// Racines de a*x^2 + b*x + c. La forme q = -(b + sgn(b)*sqrt(D))/2,
+/// x1 = q/a, x2 = c/q evite la soustraction de deux valeurs voisines.
+inline unsigned int quadratic(double a, double b, double c, real lo, real hi, real *out)
+{
+	if (a == 0) return linear(b, c, lo, hi, out);
+
+	auto discriminant = b*b - 4*a*c;
+	unsigned int count = 0;
+
+	if (discriminant < 0) return 0;
+	if (discriminant == 0) {
+		keep(-b/(2*a), lo, hi, out, count);
+		return count;
+	}
+
+	auto q = -(b + std::copysign(std::sqrt(discriminant), b))/2;
+	keep(q/a, lo, hi, out, count);
+	keep(c/q, lo, hi, out, count);
+	sort(out, count);
+	return count;
+}
+
+/// Racines de a*x^3 + b*x^2 + c*x + d. Apres le changement de variable
+/// x = y - b/(3a), l'equation devient y^3 + p*y + q = 0. Chaque racine
+/// est affinee par un pas de Newton sur le polynome d'origine.
+inline unsigned int cubic(double a, double b, double c, double d, real lo, real hi, real *out)
+{
+	if (std::fabs(a) <= std::numeric_limits<real>::epsilon()*std::max(std::max(std::fabs(b), std::fabs(c)), std::fabs(d))) {
+		return quadratic(b, c, d, lo, hi, out);
+	}
+
+	auto A = b/a, B = c/a, C = d/a;
+	auto p = B - A*A/3, q = 2*A*A*A/27 - A*B/3 + C;
+	auto shift = -A/3;
+	auto delta = q*q/4 + p*p*p/27;
+	double xs[3];
+	unsigned int n = 0;
+
+	if (delta < 0) {
+		// Trois racines reelles: y = r*cos(phi - 2k*pi/3).
+		const double third = 2*std::acos(-1.)/3;
+		auto r = 2*std::sqrt(-p/3);
+		auto phi = std::acos(std::min(std::max(3*q/(p*r), -1.), 1.))/3;
+		for (; n < 3; ++n) {
+			xs[n] = r*std::cos(phi - third*n) + shift;
+		}
+	} else {
+		// Une racine simple u + v, avec u*v = -p/3; u est choisi du plus
+		// grand module. Si delta = 0, -u est de plus racine double.
+		auto u = std::cbrt(-q/2 - std::copysign(std::sqrt(delta), q));
+		xs[n++] = (u != 0 ? u - p/(3*u) : 0) + shift;
+		if (delta == 0 && u != 0) {
+			xs[n++] = -u + shift;
+		}
+	}
+
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < n; ++i) {
+		auto x = xs[i];
+		auto f = ((a*x + b)*x + c)*x + d, df = (3*a*x + 2*b)*x + c;
+		if (df != 0) {
+			x -= f/df;
+		}
+		keep(x, lo, hi, out, count);
+	}
+	sort(out, count);
+	return count;
+}
+
+/// Resout p(x) = 0 dans [lo, hi] ou p change de signe (p(lo) = flo) et
+/// est monotone, par la methode de Newton. Un pas qui sortirait de
+/// l'intervalle est remplace par une bissection.
+template <typename P, typename D>
+real bracket(const P &p, const D &d, real lo, real hi, real flo)
+{
+	auto x = (lo + hi)/2;
+
+	for (unsigned int i = 0; i < 64; ++i) {
+		auto fx = p(x);
+		if (fx == 0) break;
+
+		if ((fx < 0) == (flo < 0)) {
+			lo = x;
+		} else {
+			hi = x;
+		}
+
+		auto dfx = d(x);
+		auto next = dfx != 0 ? x - fx/dfx : lo;
+		if (! (next > lo && next < hi)) {
+			next = (lo + hi)/2;
+		}
+		if (next == x) break;
+		x = next;
+	}
+	return x;
+}
+}
+
+template <unsigned int N>
+unsigned int Polynomial<N>::roots(real lo, real hi, real *out) const
+{
+	auto d = derived();
+
+	// Bornes des intervalles de monotonie: lo, racines de la derivee, hi.
+	real points[N + 1];
+	points[0] = lo;
+	auto n = 1 + d.roots(lo, hi, points + 1);
+	points[n++] = hi;
+
+	unsigned int count = 0;
+	auto f0 = (*this)(lo);
+
+	for (unsigned int i = 0; i + 1 < n && count < N; ++i) {
+		auto x0 = points[i], x1 = points[i + 1];
+		auto f1 = (*this)(x1);
+
+		if (negligible(x0)) {
+			if (count == 0 || out[count - 1] != x0) {
+				out[count++] = x0;
+			}
+		} else if (! negligible(x1) && (f0 < 0) != (f1 < 0)) {
+			out[count++] = solver::bracket(*this, d, x0, x1, f0);
+		}
+		f0 = f1;
+	}
+	if (count < N && negligible(hi) && (count == 0 || out[count - 1] != hi)) {
+		out[count++] = hi;
+	}
+	return count;
+}
+
+template <>
+inline unsigned int Polynomial<0>::roots(real, real, real *) const
+{
+	return 0;
+}
+
+template <>
+inline unsigned int Polynomial<1>::roots(real lo, real hi, real *out) const
+{
+	return solver::linear(factors[1], factors[0], lo, hi, out);
+}
+
+template <>
+inline unsigned int Polynomial<2>::roots(real lo, real hi, real *out) const
+{
+	return solver::quadratic(factors[2], factors[1], factors[0], lo, hi, out);
+}
+
+template <>
+inline unsigned int Polynomial<3>::roots(real lo, real hi, real *out) const
+{
+	return solver::cubic(factors[3], factors[2], factors[1], factors[0], lo, hi, out);
+}
 }
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "rasterbackend.h"
+
+#include "rect.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace nealrame;
+
+const int RasterBackend::TileSize;
+
+RasterBackend::RasterBackend(int width, int height, unsigned int threads) :
+	image_(width, height),
+	color_(Color::Black),
+	width_(1),
+	columns_((image_.width() + TileSize - 1)/TileSize),
+	rows_((image_.height() + TileSize - 1)/TileSize),
+	bins_(std::size_t(columns_)*rows_),
+	pool_(new ThreadPool(threads))
+{
+	rasterizers_.resize(pool_->size(), Rasterizer(TileSize, TileSize));
+}
+
+RasterBackend::~RasterBackend()
+{ }
+
+/// Un effacement recouvre toute l'image: les commandes precedentes sont
+/// abandonnees.
+bool RasterBackend::clear()
+{
+	commands_.clear();
+	edges_.clear();
+	commands_.push_back({
+		color_, FillRule::NonZero, true, 0, 0,
+		0, 0, image_.width(), image_.height()
+	});
+	return true;
+}
+
+bool RasterBackend::setDrawColor(const Color &c)
+{
+	color_ = c;
+	return true;
+}
+
+bool RasterBackend::setLineWidth(real width)
+{
+	if (width <= 0) return false;
+	width_ = width;
+	return true;
+}
+
+bool RasterBackend::drawPolyline(const Polyline &polyline, const Point &offset)
+{
+	pending_.addStroke(polyline.data(), polyline.size(), width_, offset);
+	record(FillRule::NonZero);
+	return true;
+}
+
+bool RasterBackend::drawRect(const Rect &r)
+{
+	const Point corners[] = {
+		r.topLeft(), r.topRight(), r.bottomRight(), r.bottomLeft()
+	};
+	pending_.addStroke(corners, 4, width_, Point{0, 0}, true);
+	record(FillRule::NonZero);
+	return true;
+}
+
+bool RasterBackend::fill(const std::vector<Polyline> &contours, FillRule rule)
+{
+	for (auto &contour: contours) {
+		pending_.addContour(contour.data(), contour.size());
+	}
+	record(rule);
+	return true;
+}
+
+bool RasterBackend::fill(const EdgeList &edges, FillRule rule)
+{
+	auto points = edges.data();
+	for (std::size_t i = 0, count = edges.size(); i < count; ++i) {
+		pending_.addLine(points[2*i], points[2*i + 1]);
+	}
+	record(rule);
+	return true;
+}
+
+void RasterBackend::present()
+{
+	flush();
+}
+
+/// Repartit les commandes dans les tuiles qu'elles touchent puis rasterise
+/// les tuiles en parallele.
+void RasterBackend::flush()
+{
+	if (commands_.empty()) return;
+
+	for (auto &bin: bins_) {
+		bin.clear();
+	}
+
+	for (std::size_t i = 0; i < commands_.size(); ++i) {
+		auto &command = commands_[i];
+		auto column0 = std::max(command.x0/TileSize, 0);
+		auto column1 = std::min((command.x1 - 1)/TileSize, columns_ - 1);
+		auto row0 = std::max(command.y0/TileSize, 0);
+		auto row1 = std::min((command.y1 - 1)/TileSize, rows_ - 1);
+
+		for (auto row = row0; row <= row1; ++row) {
+			for (auto column = column0; column <= column1; ++column) {
+				bins_[std::size_t(row)*columns_ + column].push_back(i);
+			}
+		}
+	}
+
+	pool_->parallelFor(bins_.size(), [this](std::size_t tile, unsigned int worker) {
+		renderTile(tile, worker);
+	});
+
+	commands_.clear();
+	edges_.clear();
+}
+
+const Image & RasterBackend::image() const
+{
+	return image_;
+}
+
+/// Enregistre les segments en attente comme une commande de remplissage,
+/// avec leur boite englobante en pixels.
+void RasterBackend::record(FillRule rule)
+{
+	if (pending_.empty()) return;
+
+	auto min = pending_.min(), max = pending_.max();
+	auto x0 = std::max(int(std::floor(min.x)), 0);
+	auto y0 = std::max(int(std::floor(min.y)), 0);
+	auto x1 = std::min(int(std::ceil(max.x)) + 1, image_.width());
+	auto y1 = std::min(int(std::ceil(max.y)) + 1, image_.height());
+
+	if (x0 < x1 && y0 < y1) {
+		auto first = edges_.size();
+		edges_.insert(edges_.end(), pending_.data(), pending_.data() + 2*pending_.size());
+		commands_.push_back({
+			color_, rule, false, first, edges_.size(),
+			x0, y0, x1, y1
+		});
+	}
+	pending_.clear();
+}
+
+void RasterBackend::renderTile(std::size_t tile, unsigned int worker)
+{
+	auto &bin = bins_[tile];
+	if (bin.empty()) return;
+
+	auto &rasterizer = rasterizers_[worker];
+	auto x0 = int(tile%columns_)*TileSize;
+	auto y0 = int(tile/columns_)*TileSize;
+	auto x1 = std::min(x0 + TileSize, image_.width());
+	auto y1 = std::min(y0 + TileSize, image_.height());
+
+	rasterizer.setOrigin(x0, y0);
+
+	for (auto i: bin) {
+		auto &command = commands_[i];
+
+		if (command.clear) {
+			image_.fill(x0, y0, x1, y1, command.color);
+			continue;
+		}
+
+		rasterizer.addLines(edges_.data() + command.first, (command.last - command.first)/2);
+		rasterizer.sweep(command.rule, [&](int y, int sx0, int sx1, const real *coverage) {
+			if (y < y1) {
+				image_.blend(y, sx0, std::min(sx1, x1), coverage, command.color);
+			}
+		});
+	}
+}
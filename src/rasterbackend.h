@@ -0,0 +1,73 @@
+#pragma once
+
+#include "backend.h"
+#include "color.h"
+#include "image.h"
+#include "rasterizer.h"
+
+#include <memory>
+#include <vector>
+
+namespace nealrame
+{
+class ThreadPool;
+
+/// Implementation logicielle du dessin: tout est rasterise, avec
+/// anti-crenelage, dans une image RGBA en memoire. Ne necessite ni
+/// affichage ni carte graphique.
+///
+/// Les commandes de dessin sont enregistrees puis executees par flush()
+/// (appele par present()): chaque commande est affectee aux tuiles de
+/// TileSize x TileSize pixels que touche sa boite englobante, puis les
+/// tuiles sont rasterisees en parallele. Chaque tuile n'ecrit que ses
+/// propres pixels: aucun verrou n'est necessaire sur l'image.
+class RasterBackend : public Backend {
+public:
+	static const int TileSize = 64;
+
+public:
+	/// Construit une image de width x height pixels, rendue par threads
+	/// threads (0 pour le nombre de coeurs disponibles).
+	RasterBackend(int width, int height, unsigned int threads = 0);
+	virtual ~RasterBackend();
+
+	virtual bool clear();
+	virtual bool setDrawColor(const Color &);
+	virtual bool setLineWidth(real width);
+	virtual bool drawPolyline(const Polyline &, const Point &offset);
+	virtual bool drawRect(const Rect &);
+	virtual bool fill(const std::vector<Polyline> &contours, FillRule);
+	virtual bool fill(const EdgeList &, FillRule);
+	virtual void present();
+
+	/// Execute les commandes enregistrees.
+	void flush();
+
+	/// Retourne l'image produite par le dernier flush().
+	const Image & image() const;
+
+private:
+	struct Command {
+		Color color;
+		FillRule rule;
+		bool clear;
+		std::size_t first, last;
+		int x0, y0, x1, y1;
+	};
+
+	void record(FillRule);
+	void renderTile(std::size_t tile, unsigned int worker);
+
+private:
+	Image image_;
+	Color color_;
+	real width_;
+	EdgeList pending_;
+	std::vector<Point> edges_;
+	std::vector<Command> commands_;
+	int columns_, rows_;
+	std::vector<std::vector<std::size_t>> bins_;
+	std::vector<Rasterizer> rasterizers_;
+	std::unique_ptr<ThreadPool> pool_;
+};
+}
@@ -0,0 +1,270 @@
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace nealrame;
+
+EdgeList::EdgeList()
+{
+	clear();
+}
+
+void EdgeList::addLine(const Point &a, const Point &b)
+{
+	points_.push_back(a);
+	points_.push_back(b);
+
+	min_.x = std::min(min_.x, std::min(a.x, b.x));
+	min_.y = std::min(min_.y, std::min(a.y, b.y));
+	max_.x = std::max(max_.x, std::max(a.x, b.x));
+	max_.y = std::max(max_.y, std::max(a.y, b.y));
+}
+
+void EdgeList::addContour(const Point *points, std::size_t count, const Point &offset)
+{
+	if (count < 2) return;
+
+	for (std::size_t i = 1; i < count; ++i) {
+		addLine(points[i - 1] + offset, points[i] + offset);
+	}
+	addLine(points[count - 1] + offset, points[0] + offset);
+}
+
+void EdgeList::addStroke(
+	const Point *points, std::size_t count, real width,
+	const Point &offset, bool closed)
+{
+	auto segment = [&](const Point &a, const Point &b) {
+		auto d = b - a;
+		auto length = std::sqrt(SQUARE(d.x) + SQUARE(d.y));
+		if (length <= 0) return;
+
+		auto n = Point{-d.y, d.x}*(width/(2*length));
+		const Point quad[] = {a + n, b + n, b - n, a - n};
+		addContour(quad, 4, offset);
+	};
+
+	for (std::size_t i = 1; i < count; ++i) {
+		segment(points[i - 1], points[i]);
+	}
+	if (closed && count > 2) {
+		segment(points[count - 1], points[0]);
+	}
+}
+
+void EdgeList::clear()
+{
+	auto inf = std::numeric_limits<real>::infinity();
+
+	points_.clear();
+	min_ = Point{inf, inf};
+	max_ = Point{-inf, -inf};
+}
+
+bool EdgeList::empty() const
+{ return points_.empty(); }
+
+std::size_t EdgeList::size() const
+{ return points_.size()/2; }
+
+const Point * EdgeList::data() const
+{ return points_.data(); }
+
+Point EdgeList::min() const
+{ return min_; }
+
+Point EdgeList::max() const
+{ return max_; }
+
+Rasterizer::Rasterizer(int width, int height) :
+	origin_(Point{0, 0})
+{
+	resize(width, height);
+}
+
+/// Chaque ligne de l'accumulateur a deux cellules de plus que l'image: les
+/// segments ramenes sur le bord droit y deposent leur contribution.
+void Rasterizer::resize(int width, int height)
+{
+	width_ = std::max(width, 0);
+	height_ = std::max(height, 0);
+	stride_ = width_ + 2;
+	xmin_ = ymin_ = std::numeric_limits<int>::max();
+	xmax_ = ymax_ = std::numeric_limits<int>::min();
+	accumulation_.assign(std::size_t(stride_)*height_, 0);
+	coverage_.resize(width_);
+}
+
+void Rasterizer::setOrigin(int x, int y)
+{
+	origin_ = Point{real(x), real(y)};
+}
+
+int Rasterizer::width() const
+{ return width_; }
+
+int Rasterizer::height() const
+{ return height_; }
+
+/// Le segment est coupe aux abscisses 0 et width: les morceaux situes hors
+/// de l'image sont remplaces par leur projection sur le bord, qui a la
+/// meme contribution au nombre d'enroulement des pixels visibles.
+void Rasterizer::addLine(const Point &a, const Point &b)
+{
+	auto p0 = a - origin_, p1 = b - origin_;
+	real w = width_;
+	real ts[4] = {0, 1, 1, 1};
+	unsigned int n = 1;
+
+	if ((p0.x < 0) != (p1.x < 0)) {
+		ts[n++] = (0 - p0.x)/(p1.x - p0.x);
+	}
+	if ((p0.x > w) != (p1.x > w)) {
+		ts[n++] = (w - p0.x)/(p1.x - p0.x);
+	}
+	ts[n] = 1;
+	std::sort(ts + 1, ts + n);
+
+	auto d = p1 - p0;
+	auto clamp = [w](Point p) {
+		p.x = std::min(std::max(p.x, real(0)), w);
+		return p;
+	};
+
+	for (unsigned int i = 0; i < n; ++i) {
+		auto q0 = i == 0 ? p0 : p0 + d*ts[i];
+		auto q1 = i + 1 == n ? p1 : p0 + d*ts[i + 1];
+		accumulate(clamp(q0), clamp(q1));
+	}
+}
+
+void Rasterizer::addLines(const Point *points, std::size_t count)
+{
+	for (std::size_t i = 0; i < count; ++i, points += 2) {
+		addLine(points[0], points[1]);
+	}
+}
+
+void Rasterizer::add(const EdgeList &edges)
+{
+	addLines(edges.data(), edges.size());
+}
+
+/// Depose l'aire signee delimitee par le segment [a, b] (d'abscisses
+/// comprises entre 0 et width) sur chaque ligne de pixels qu'il traverse.
+///
+/// Pour plus d'infos consulter:
+///   https://medium.com/@raphlinus/inside-the-fastest-font-renderer-in-the-world-75ae5270c445
+void Rasterizer::accumulate(const Point &a, const Point &b)
+{
+	if (a.y == b.y) return;
+
+	auto dir = real(a.y < b.y ? 1 : -1);
+	auto &p0 = a.y < b.y ? a : b;
+	auto &p1 = a.y < b.y ? b : a;
+
+	auto dxdy = (p1.x - p0.x)/(p1.y - p0.y);
+	auto x = p0.x;
+
+	if (p0.y < 0) {
+		x -= p0.y*dxdy;
+	}
+
+	// Les erreurs d'arrondi ne doivent pas faire sortir les abscisses de
+	// [0, width].
+	auto clamp = [this](real v) {
+		return std::min(std::max(v, real(0)), real(width_));
+	};
+	x = clamp(x);
+
+	auto y0 = std::max(int(std::floor(p0.y)), 0);
+	auto y1 = std::min(int(std::ceil(p1.y)), height_);
+
+	if (y0 >= y1) return;
+
+	ymin_ = std::min(ymin_, y0);
+	ymax_ = std::max(ymax_, y1 - 1);
+
+	for (auto y = y0; y < y1; ++y) {
+		auto line = accumulation_.data() + std::size_t(y)*stride_;
+		auto dy = std::min(real(y + 1), p1.y) - std::max(real(y), p0.y);
+		auto xnext = clamp(x + dxdy*dy);
+		auto d = dy*dir;
+
+		auto x0 = std::min(x, xnext), x1 = std::max(x, xnext);
+		auto x0floor = std::floor(x0);
+		auto x0i = int(x0floor);
+		auto x1ceil = std::ceil(x1);
+		auto x1i = int(x1ceil);
+
+		xmin_ = std::min(xmin_, x0i);
+		xmax_ = std::max(xmax_, std::max(x1i, x0i + 1));
+
+		if (x1i <= x0i + 1) {
+			// Le segment reste dans un seul pixel de la ligne.
+			auto xmf = real(.5)*(x + xnext) - x0floor;
+			line[x0i] += d - d*xmf;
+			line[x0i + 1] += d*xmf;
+		} else {
+			auto s = 1/(x1 - x0);
+			auto x0f = x0 - x0floor;
+			auto a0 = real(.5)*s*SQUARE(1 - x0f);
+			auto x1f = x1 - x1ceil + 1;
+			auto am = real(.5)*s*SQUARE(x1f);
+
+			line[x0i] += d*a0;
+			if (x1i == x0i + 2) {
+				line[x0i + 1] += d*(1 - a0 - am);
+			} else {
+				auto a1 = s*(real(1.5) - x0f);
+				line[x0i + 1] += d*(a1 - a0);
+				for (auto xi = x0i + 2; xi < x1i - 1; ++xi) {
+					line[xi] += d*s;
+				}
+				auto a2 = a1 + (x1i - x0i - 3)*s;
+				line[x1i - 1] += d*(1 - a2 - am);
+			}
+			line[x1i] += d*am;
+		}
+		x = xnext;
+	}
+}
+
+void Rasterizer::sweep(FillRule rule, const SpanFunction &span)
+{
+	if (ymin_ <= ymax_) {
+		auto x0 = std::max(xmin_, 0);
+		auto x1 = std::min(xmax_ + 1, width_);
+		auto end = std::min(xmax_, stride_ - 1) + 1;
+
+		for (auto y = ymin_; y <= ymax_; ++y) {
+			auto line = accumulation_.data() + std::size_t(y)*stride_;
+			auto coverage = coverage_.data();
+			real acc = 0;
+
+			for (auto x = x0; x < x1; ++x) {
+				acc += line[x];
+				auto c = std::fabs(acc);
+				if (rule == FillRule::EvenOdd) {
+					c = std::fmod(c, real(2));
+					c = c > 1 ? 2 - c : c;
+				}
+				coverage[x - x0] = std::min(c, real(1));
+			}
+
+			if (x0 < x1) {
+				span(
+					y + int(origin_.y),
+					x0 + int(origin_.x), x1 + int(origin_.x),
+					coverage
+				);
+			}
+			std::fill(line + x0, line + end, real(0));
+		}
+	}
+
+	xmin_ = ymin_ = std::numeric_limits<int>::max();
+	xmax_ = ymax_ = std::numeric_limits<int>::min();
+}
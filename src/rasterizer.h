@@ -0,0 +1,104 @@
+#pragma once
+
+#include "common.h"
+#include "path.h"
+#include "point.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace nealrame
+{
+/// Liste de segments orientes delimitant une zone a remplir, avec leur
+/// boite englobante.
+class EdgeList {
+public:
+	EdgeList();
+
+	/// Ajoute un segment oriente.
+	void addLine(const Point &, const Point &);
+
+	/// Ajoute le contour ferme de count points, decale de offset.
+	void addContour(const Point *points, std::size_t count, const Point &offset = Point{0, 0});
+
+	/// Ajoute le trace, d'epaisseur width, de la ligne brisee de count
+	/// points decalee de offset. Chaque segment est ajoute sous forme d'un
+	/// quadrilatere de meme orientation, si bien que leur union est
+	/// correctement remplie avec la regle FillRule::NonZero.
+	void addStroke(
+		const Point *points, std::size_t count, real width,
+		const Point &offset = Point{0, 0}, bool closed = false);
+
+	void clear();
+	bool empty() const;
+
+	/// Nombre de segments.
+	std::size_t size() const;
+
+	/// Extremites des segments: 2*size() points.
+	const Point * data() const;
+
+	/// Boite englobante des segments (vide si la liste l'est).
+	Point min() const;
+	Point max() const;
+
+private:
+	std::vector<Point> points_;
+	Point min_, max_;
+};
+
+/// Rasterizer anti-crenele par accumulation de couverture signee: chaque
+/// segment depose, sur les pixels qu'il traverse, l'aire exacte qu'il
+/// delimite sur chaque ligne; une somme cumulee le long de chaque ligne
+/// donne ensuite la couverture (et le nombre d'enroulement) de chaque
+/// pixel.
+///
+/// Les segments sont usuellement construits dans une EdgeList. Les contours
+/// doivent etre fermes. Les parties situees hors de la zone
+/// [0, width]x[0, height] sont ecartees ou ramenees sur les bords.
+class Rasterizer {
+public:
+	/// Fonction recevant, pour la ligne y, la couverture (entre 0 et 1) des
+	/// pixels x0 a x1 exclus: coverage[i] pour le pixel x0 + i. Les
+	/// coordonnees tiennent compte de l'origine (voir setOrigin()).
+	typedef std::function<void(int y, int x0, int x1, const real *coverage)> SpanFunction;
+
+public:
+	Rasterizer(int width = 0, int height = 0);
+
+	void resize(int width, int height);
+	int width() const;
+	int height() const;
+
+	/// Place le pixel (0, 0) du rasterizer au point (x, y): tout segment
+	/// ajoute est d'abord translate de (-x, -y). Permet de rasteriser une
+	/// tuile d'une image plus grande.
+	void setOrigin(int x, int y);
+
+	/// Ajoute un segment oriente.
+	void addLine(const Point &, const Point &);
+
+	/// Ajoute count segments, dont les extremites sont rangees par paires
+	/// dans points.
+	void addLines(const Point *points, std::size_t count);
+
+	/// Ajoute les segments de la liste.
+	void add(const EdgeList &);
+
+	/// Calcule la couverture des pixels touches depuis le dernier appel et
+	/// la transmet ligne par ligne a span. Le rasterizer est ensuite pret
+	/// pour un nouveau remplissage.
+	void sweep(FillRule, const SpanFunction &span);
+
+private:
+	void accumulate(const Point &, const Point &);
+
+private:
+	int width_, height_, stride_;
+	Point origin_;
+	int xmin_, xmax_, ymin_, ymax_;
+	std::vector<real> accumulation_;
+	std::vector<real> coverage_;
+};
+}
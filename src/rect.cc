@@ -1,7 +1,13 @@
 #include "rect.h"
 
+#include <type_traits>
+
+#include <boost/format.hpp>
+
 using namespace nealrame;
 
+static_assert(std::is_trivially_copyable<Rect>::value, "Rect must stay trivially copyable");
+
 Rect::Rect(Point top_left, Point bottom_right) :
 	topLeft_({
 		std::min(top_left.x, bottom_right.x),
@@ -21,13 +27,6 @@ Rect::Rect(Point top_left, real width, real height)
 	);
 }
 
-Rect & Rect::operator=(const Rect &rhs)
-{
-	topLeft_ = rhs.topLeft_;
-	bottomRight_ = rhs.bottomRight_;
-	return *this;
-}
-
 float Rect::width() const
 { return fabs(bottomRight_.x - topLeft_.x); }
 
@@ -88,9 +87,9 @@ Rect Rect::translated(const Point &p) const
 	return Rect(*this).translate(p);
 }
 
-std::string Rect::toString() const
+std::string Rect::toString(const std::string &name) const
 {
-	return (boost::format("%s[%1%, %2%, %3%, %4%]")
+	return (boost::format("%1%[%2%, %3%, %4%, %5%]")
 			% name
 			% topLeft_.x
 			% topLeft_.y
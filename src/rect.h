@@ -5,6 +5,7 @@
 #include "size.h"
 
 #include <cmath>
+#include <string>
 
 namespace nealrame
 {
@@ -12,16 +13,12 @@ class Rect {
 	Point topLeft_;
 	Point bottomRight_;
 public:
-	std::string name;
-
 	Rect() 
 	{ }
 
 	Rect(Point top_left, Point bottom_right);
 	Rect(Point top_left, real width, real height);
 
-	Rect & operator=(const Rect &rhs);
-
 	float width() const;
 	float height() const;
 
@@ -47,6 +44,6 @@ public:
 	Rect translated(real x, real y) const;
 	Rect translated(const Point &p) const;
 
-	std::string toString() const;
+	std::string toString(const std::string &name = "") const;
 };
 }
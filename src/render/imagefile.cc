@@ -0,0 +1,227 @@
+#include "imagefile.h"
+
+#include "error.h"
+#include "image.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ostream>
+
+using namespace nealrame;
+
+namespace
+{
+const std::size_t MaxStoredBlock = 65535;
+
+/// Table du CRC-32 (polynome 0xedb88320) utilise par les blocs PNG.
+struct CrcTable {
+	uint32_t values[256];
+
+	CrcTable()
+	{
+		for (uint32_t n = 0; n < 256; ++n) {
+			auto c = n;
+			for (int k = 0; k < 8; ++k) {
+				c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			values[n] = c;
+		}
+	}
+};
+
+uint32_t crc32(const uint8_t *data, std::size_t size)
+{
+	static const CrcTable table;
+	uint32_t c = 0xffffffffu;
+
+	for (std::size_t i = 0; i < size; ++i) {
+		c = table.values[(c ^ data[i]) & 0xff] ^ (c >> 8);
+	}
+	return c ^ 0xffffffffu;
+}
+
+/// Somme de controle Adler-32 terminant un flux zlib, mise a jour avec
+/// size octets.
+void adler32(uint32_t &a, uint32_t &b, const uint8_t *data, std::size_t size)
+{
+	// 5552 octets au plus entre deux reductions: b ne peut deborder.
+	while (size > 0) {
+		auto n = std::min<std::size_t>(size, 5552);
+		for (std::size_t i = 0; i < n; ++i) {
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += n;
+		size -= n;
+	}
+}
+
+void put8(std::vector<uint8_t> &buffer, uint8_t v)
+{
+	buffer.push_back(v);
+}
+
+void put16le(std::vector<uint8_t> &buffer, uint16_t v)
+{
+	buffer.push_back(v & 0xff);
+	buffer.push_back(v >> 8);
+}
+
+void put32be(std::vector<uint8_t> &buffer, uint32_t v)
+{
+	buffer.push_back(v >> 24);
+	buffer.push_back((v >> 16) & 0xff);
+	buffer.push_back((v >> 8) & 0xff);
+	buffer.push_back(v & 0xff);
+}
+
+/// Ouvre un bloc PNG de type type et de taille length. Retourne la position
+/// du debut du type, a partir de laquelle le CRC est calcule.
+std::size_t beginChunk(std::vector<uint8_t> &buffer, const char *type, uint32_t length)
+{
+	put32be(buffer, length);
+	auto start = buffer.size();
+	buffer.insert(buffer.end(), type, type + 4);
+	return start;
+}
+
+void endChunk(std::vector<uint8_t> &buffer, std::size_t start)
+{
+	put32be(buffer, crc32(buffer.data() + start, buffer.size() - start));
+}
+}
+
+ImageFormat nealrame::imageFormat(const std::string &filename)
+{
+	auto dot = filename.rfind('.');
+	if (dot == std::string::npos) {
+		return ImageFormat::Ppm;
+	}
+
+	auto extension = filename.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+	return extension == "png" ? ImageFormat::Png : ImageFormat::Ppm;
+}
+
+ImageWriter::ImageWriter(ImageFormat format) :
+	format_(format)
+{ }
+
+ImageFormat ImageWriter::format() const
+{
+	return format_;
+}
+
+void ImageWriter::write(const Image &image, std::ostream &out)
+{
+	buffer_.clear();
+
+	switch (format_) {
+	case ImageFormat::Ppm:
+		encodePpm(image);
+		break;
+	case ImageFormat::Png:
+		encodePng(image);
+		break;
+	}
+
+	out.write(reinterpret_cast<const char *>(buffer_.data()), buffer_.size());
+	if (! out) {
+		throw Error("ImageWriter: write failed");
+	}
+}
+
+/// PPM binaire (P6): la composante alpha est ignoree.
+void ImageWriter::encodePpm(const Image &image)
+{
+	auto header = "P6\n" + std::to_string(image.width()) + " "
+		+ std::to_string(image.height()) + "\n255\n";
+	auto pixels = std::size_t(image.width())*image.height();
+
+	buffer_.reserve(header.size() + 3*pixels);
+	buffer_.insert(buffer_.end(), header.begin(), header.end());
+
+	auto rgba = image.data();
+	for (std::size_t i = 0; i < pixels; ++i, rgba += 4) {
+		buffer_.insert(buffer_.end(), rgba, rgba + 3);
+	}
+}
+
+/// PNG RGBA sans compression: les lignes, precedees du filtre 0, sont
+/// rangees dans des blocs deflate non compresses. L'encodage ne coute
+/// qu'une copie et deux sommes de controle par octet, ce qui le laisse loin
+/// derriere le rendu.
+void ImageWriter::encodePng(const Image &image)
+{
+	static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+	auto width = std::size_t(image.width()), height = std::size_t(image.height());
+	auto stride = 4*width;
+	auto raw = height*(stride + 1);
+	auto blocks = std::max<std::size_t>((raw + MaxStoredBlock - 1)/MaxStoredBlock, 1);
+	auto length = 2 + 5*blocks + raw + 4;
+
+	if (length > 0x7fffffffu) {
+		throw Error("ImageWriter: image too large for PNG");
+	}
+
+	buffer_.reserve(sizeof(signature) + 25 + length + 12 + 12);
+	buffer_.insert(buffer_.end(), signature, signature + sizeof(signature));
+
+	auto start = beginChunk(buffer_, "IHDR", 13);
+	put32be(buffer_, uint32_t(width));
+	put32be(buffer_, uint32_t(height));
+	put8(buffer_, 8);  // bits par composante
+	put8(buffer_, 6);  // RGBA
+	put8(buffer_, 0);  // deflate
+	put8(buffer_, 0);  // filtrage adaptatif
+	put8(buffer_, 0);  // non entrelace
+	endChunk(buffer_, start);
+
+	start = beginChunk(buffer_, "IDAT", uint32_t(length));
+	put8(buffer_, 0x78);
+	put8(buffer_, 0x01);
+
+	uint32_t a = 1, b = 0;
+	std::size_t row = 0, column = 0, left = raw;
+
+	do {
+		auto size = std::min(left, MaxStoredBlock);
+		left -= size;
+
+		put8(buffer_, left == 0 ? 1 : 0);
+		put16le(buffer_, uint16_t(size));
+		put16le(buffer_, uint16_t(~size));
+
+		// Les blocs ne sont pas alignes sur les lignes: column est la
+		// position dans la ligne courante, 0 designant l'octet de filtre.
+		while (size > 0) {
+			auto first = buffer_.size();
+			if (column == 0) {
+				put8(buffer_, 0);
+				--size;
+				++column;
+			}
+			auto n = std::min(size, stride + 1 - column);
+			auto line = image.line(int(row)) + (column - 1);
+			buffer_.insert(buffer_.end(), line, line + n);
+			adler32(a, b, buffer_.data() + first, buffer_.size() - first);
+			size -= n;
+			column += n;
+			if (column == stride + 1) {
+				column = 0;
+				++row;
+			}
+		}
+	} while (left > 0);
+
+	put32be(buffer_, (b << 16) | a);
+	endChunk(buffer_, start);
+
+	start = beginChunk(buffer_, "IEND", 0);
+	endChunk(buffer_, start);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace nealrame
+{
+class Image;
+
+/// Formats d'image produits par bezier-render.
+enum class ImageFormat {
+	Ppm, Png
+};
+
+/// Retourne le format correspondant a l'extension de filename (PPM par
+/// defaut).
+ImageFormat imageFormat(const std::string &filename);
+
+/// Encode des images dans un tampon reutilise d'une image a l'autre, puis
+/// les ecrit d'un bloc.
+class ImageWriter {
+public:
+	ImageWriter(ImageFormat);
+
+	ImageFormat format() const;
+
+	/// Encode l'image et l'ecrit dans out. Leve une Error si l'ecriture
+	/// echoue.
+	void write(const Image &, std::ostream &out);
+
+private:
+	void encodePpm(const Image &);
+	void encodePng(const Image &);
+
+private:
+	ImageFormat format_;
+	std::vector<uint8_t> buffer_;
+};
+}
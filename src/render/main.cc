@@ -0,0 +1,297 @@
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/format.hpp>
+
+#include "color.h"
+#include "error.h"
+#include "flatten.h"
+#include "image.h"
+#include "painter.h"
+#include "rasterbackend.h"
+
+#include "imagefile.h"
+#include "scenefile.h"
+
+using namespace nealrame;
+
+namespace
+{
+void usage(std::ostream &out)
+{
+	out <<
+		"usage: bezier-render [options] [scene]\n"
+		"\n"
+		"Renders each frame of scene (standard input if omitted or '-')\n"
+		"without opening a window.\n"
+		"\n"
+		"  -o output     output file; a printf-like pattern such as\n"
+		"                frame%05d.png gives one file per frame, otherwise\n"
+		"                frames are written one after the other ('-' for\n"
+		"                standard output). Default: frame%05d.ppm\n"
+		"  -f ppm|png    image format (default: from the output extension)\n"
+		"  -j threads    rendering threads (default: one per core)\n"
+		"  -t tolerance  flattening tolerance in pixels (default: 0.25)\n"
+		"  -v            print throughput statistics on standard error\n"
+		"  -h            show this help\n";
+}
+
+/// Ecrit les images dans un thread dedie, pendant que les suivantes sont
+/// rendues. Au plus depth images sont en attente: au-dela, write() bloque
+/// plutot que de laisser la memoire croitre si l'ecriture est plus lente
+/// que le rendu. Les images ecrites sont recyclees.
+class FrameWriter {
+public:
+	FrameWriter(const std::string &output, ImageFormat format, std::size_t depth) :
+		output_(output),
+		writer_(format),
+		depth_(depth),
+		stop_(false),
+		thread_(&FrameWriter::run, this)
+	{ }
+
+	~FrameWriter()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		pending_.notify_one();
+		if (thread_.joinable()) {
+			thread_.join();
+		}
+	}
+
+	void write(unsigned long index, const Image &image)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		ready_.wait(lock, [&]{ return queue_.size() < depth_ || error_; });
+		rethrow();
+
+		std::unique_ptr<Image> copy;
+		if (free_.empty()) {
+			copy.reset(new Image(image));
+		} else {
+			copy = std::move(free_.back());
+			free_.pop_back();
+			*copy = image;
+		}
+		queue_.push_back(Item{index, std::move(copy)});
+		pending_.notify_one();
+	}
+
+	/// Attend que toutes les images soient ecrites. Leve l'erreur eventuelle
+	/// du thread d'ecriture.
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		pending_.notify_one();
+		if (thread_.joinable()) {
+			thread_.join();
+		}
+		rethrow();
+	}
+
+private:
+	struct Item {
+		unsigned long index;
+		std::unique_ptr<Image> image;
+	};
+
+	void rethrow()
+	{
+		if (error_) {
+			auto error = error_;
+			error_ = nullptr;
+			std::rethrow_exception(error);
+		}
+	}
+
+	std::ostream & open(unsigned long index)
+	{
+		if (output_ == "-") {
+			return std::cout;
+		}
+		if (output_.find('%') != std::string::npos) {
+			file_.close();
+			file_.open(
+				(boost::format(output_) % index).str(),
+				std::ios::binary|std::ios::trunc
+			);
+		} else if (! file_.is_open()) {
+			file_.open(output_, std::ios::binary|std::ios::trunc);
+		}
+		if (! file_) {
+			throw Error("cannot open output file for frame " + std::to_string(index));
+		}
+		return file_;
+	}
+
+	void run()
+	{
+		for (;;) {
+			Item item;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				pending_.wait(lock, [&]{ return stop_ || ! queue_.empty(); });
+				if (queue_.empty()) break;
+				item = std::move(queue_.front());
+				queue_.pop_front();
+			}
+
+			try {
+				writer_.write(*item.image, open(item.index));
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				error_ = std::current_exception();
+				queue_.clear();
+				ready_.notify_one();
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			free_.push_back(std::move(item.image));
+			ready_.notify_one();
+		}
+
+		file_.close();
+		std::cout.flush();
+	}
+
+private:
+	std::string output_;
+	ImageWriter writer_;
+	std::size_t depth_;
+	std::ofstream file_;
+
+	std::mutex mutex_;
+	std::condition_variable pending_, ready_;
+	std::deque<Item> queue_;
+	std::vector<std::unique_ptr<Image>> free_;
+	std::exception_ptr error_;
+	bool stop_;
+
+	std::thread thread_;
+};
+}
+
+int main(int argc, char **argv) {
+	std::string output = "frame%05d.ppm", format;
+	unsigned int threads = 0;
+	real tolerance = DefaultTolerance;
+	bool verbose = false;
+	int option;
+
+	try {
+		while ((option = getopt(argc, argv, "o:f:j:t:vh")) != -1) {
+			switch (option) {
+			case 'o':
+				output = optarg;
+				break;
+			case 'f':
+				format = optarg;
+				break;
+			case 'j':
+				threads = unsigned(std::stoul(optarg));
+				break;
+			case 't':
+				tolerance = std::stof(optarg);
+				break;
+			case 'v':
+				verbose = true;
+				break;
+			case 'h':
+				usage(std::cout);
+				return 0;
+			default:
+				usage(std::cerr);
+				return 2;
+			}
+		}
+	} catch (const std::exception &) {
+		usage(std::cerr);
+		return 2;
+	}
+
+	if (argc - optind > 1 || (! format.empty() && format != "ppm" && format != "png")) {
+		usage(std::cerr);
+		return 2;
+	}
+
+	try {
+		std::string name = optind < argc ? argv[optind] : "-";
+		std::ifstream file;
+		if (name != "-") {
+			file.open(name);
+			if (! file) {
+				throw Error("cannot open " + name);
+			}
+		}
+
+		SceneReader reader(name == "-" ? std::cin : file, name);
+		FrameWriter writer(
+			output,
+			format.empty() ? imageFormat(output)
+				: format == "png" ? ImageFormat::Png : ImageFormat::Ppm,
+			2
+		);
+
+		std::shared_ptr<RasterBackend> backend;
+		std::unique_ptr<Painter> painter;
+		Frame frame{0, 0, Color::Black, {}};
+		unsigned long count = 0;
+		auto start = std::chrono::steady_clock::now();
+
+		while (reader.next(frame)) {
+			if (! backend
+				|| backend->image().width() != frame.width
+				|| backend->image().height() != frame.height) {
+				backend = std::make_shared<RasterBackend>(frame.width, frame.height, threads);
+				painter.reset(new Painter(backend));
+			}
+
+			painter->setDrawColor(frame.background);
+			painter->clear();
+			for (auto &stroke: frame.strokes) {
+				// Les traits epais sont remplis comme des contours.
+				painter->setDrawColor(stroke.color);
+				if (stroke.width > 1) {
+					painter->strokeCurve(stroke.curve, StrokeStyle(stroke.width), tolerance);
+				} else {
+					painter->setLineWidth(stroke.width);
+					painter->drawCurve(stroke.curve, tolerance);
+				}
+			}
+			painter->present();
+
+			writer.write(count++, backend->image());
+		}
+		writer.close();
+
+		if (verbose) {
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			std::cerr << boost::format("%1% frames in %2$.3f s (%3$.1f frames/s)\n")
+				% count % elapsed.count() % (count/elapsed.count());
+		}
+		return 0;
+	} catch (const Error &err) {
+		std::cerr << err.what() << std::endl;
+	} catch (const std::exception &err) {
+		std::cerr << err.what() << std::endl;
+	}
+	return 1;
+}
@@ -0,0 +1,101 @@
+#include "scenefile.h"
+
+#include "error.h"
+
+#include <istream>
+#include <sstream>
+
+#include <boost/format.hpp>
+
+using namespace nealrame;
+
+SceneReader::SceneReader(std::istream &in, const std::string &name) :
+	in_(in),
+	name_(name),
+	lineNumber_(0),
+	state_{640, 480, Color::Black, {}},
+	width_(1),
+	color_(Color::White)
+{ }
+
+bool SceneReader::next(Frame &frame)
+{
+	frame.strokes.clear();
+
+	auto done = [&]{
+		frame.width = state_.width;
+		frame.height = state_.height;
+		frame.background = state_.background;
+		return true;
+	};
+
+	auto readColor = [&](std::istream &in) {
+		int r, g, b, a = 0xff;
+
+		if (! (in >> r >> g >> b)) {
+			fail("expected a color");
+		}
+		if (! (in >> a)) {
+			in.clear();
+		}
+		for (auto c: {r, g, b, a}) {
+			if (c < 0 || c > 0xff) fail("color component out of range");
+		}
+		return Color(r, g, b, a);
+	};
+
+	while (std::getline(in_, line_)) {
+		++lineNumber_;
+
+		auto comment = line_.find('#');
+		if (comment != std::string::npos) {
+			line_.erase(comment);
+		}
+
+		std::istringstream in(line_);
+		std::string command;
+
+		if (! (in >> command)) continue;
+
+		if (command == "curve") {
+			Point p[4];
+			for (auto &point: p) {
+				if (! (in >> point.x >> point.y)) {
+					fail("expected 8 coordinates");
+				}
+			}
+			frame.strokes.push_back({Bezier(p[0], p[1], p[2], p[3]), color_, width_});
+		} else if (command == "color") {
+			color_ = readColor(in);
+		} else if (command == "width") {
+			if (! (in >> width_) || width_ <= 0) {
+				fail("expected a positive width");
+			}
+		} else if (command == "background") {
+			state_.background = readColor(in);
+		} else if (command == "size") {
+			if (! (in >> state_.width >> state_.height)
+				|| state_.width <= 0 || state_.height <= 0) {
+				fail("expected a positive size");
+			}
+		} else if (command == "frame") {
+			return done();
+		} else {
+			fail("unknown command '" + command + "'");
+		}
+
+		if (in >> command) {
+			fail("unexpected '" + command + "'");
+		}
+	}
+
+	if (in_.bad()) {
+		fail("read error");
+	}
+	return ! frame.strokes.empty() && done();
+}
+
+void SceneReader::fail(const std::string &message) const
+{
+	throw Error((boost::format("%1%:%2%: %3%") % name_ % lineNumber_ % message).str());
+}
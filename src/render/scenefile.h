@@ -0,0 +1,67 @@
+#pragma once
+
+#include "bezier.h"
+#include "color.h"
+#include "common.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace nealrame
+{
+/// Courbe a tracer, avec sa couleur et l'epaisseur de son trait.
+struct Stroke {
+	Bezier curve;
+	Color color;
+	real width;
+};
+
+/// Image a produire.
+struct Frame {
+	int width, height;
+	Color background;
+	std::vector<Stroke> strokes;
+};
+
+/// Lecteur de fichiers de scene textuels, image par image: seule l'image
+/// courante est gardee en memoire, si bien que la taille du fichier n'est
+/// pas limitee.
+///
+/// Chaque ligne contient une commande; les lignes vides et le texte suivant
+/// un '#' sont ignores:
+///
+///     size <largeur> <hauteur>
+///     background <r> <g> <b> [<a>]
+///     color <r> <g> <b> [<a>]
+///     width <epaisseur>
+///     curve <x1> <y1> <cx1> <cy1> <cx2> <cy2> <x2> <y2>
+///     frame
+///
+/// size, background, color et width fixent l'etat courant, qui persiste
+/// d'une image a l'autre (640x480, fond noir, trait blanc d'un pixel par
+/// defaut). curve ajoute une courbe a l'image courante avec la couleur et
+/// l'epaisseur courantes; frame termine l'image courante. Les courbes
+/// suivant le dernier frame forment une derniere image.
+class SceneReader {
+public:
+	/// name n'est utilise que dans les messages d'erreur.
+	SceneReader(std::istream &in, const std::string &name);
+
+	/// Lit l'image suivante. Retourne false a la fin du fichier. Leve une
+	/// Error si le fichier est mal forme.
+	bool next(Frame &);
+
+private:
+	void fail(const std::string &message) const;
+
+private:
+	std::istream &in_;
+	std::string name_;
+	std::string line_;
+	unsigned long lineNumber_;
+	Frame state_;
+	real width_;
+	Color color_;
+};
+}
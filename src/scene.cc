@@ -0,0 +1,341 @@
+#include "scene.h"
+
+#include "error.h"
+#include "painter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace nealrame;
+
+static bool sameControlPoints(const Bezier &a, const Bezier &b)
+{
+	return a.p1() == b.p1() && a.ctrl1() == b.ctrl1()
+		&& a.ctrl2() == b.ctrl2() && a.p2() == b.p2();
+}
+
+/// Indique si les transformations ne different que par leur translation.
+static bool sameLinearPart(const Transform &a, const Transform &b)
+{
+	return a.vector({1, 0}) == b.vector({1, 0}) && a.vector({0, 1}) == b.vector({0, 1});
+}
+
+static bool sameRect(const Rect &a, const Rect &b)
+{
+	return a.topLeft() == b.topLeft() && a.bottomRight() == b.bottomRight();
+}
+
+Scene::Scene(const Color &background, real tolerance) :
+	background_(background),
+	tolerance_(tolerance),
+	hasViewport_(false),
+	dirty_(true)
+{ }
+
+Scene::NodeId Scene::add(const Node &node)
+{
+	auto id = nodes_.size();
+
+	nodes_.push_back(node);
+	index_.insert(id, boundingBox(node));
+	dirty_ = true;
+	return id;
+}
+
+Scene::NodeId Scene::addCurve(const Bezier &curve, const Color &color)
+{
+	Node node(Node::CurveNode, color);
+	node.curve = curve;
+	return add(node);
+}
+
+Scene::NodeId Scene::addStroke(const Bezier &curve, const StrokeStyle &style, const Color &color)
+{
+	Node node(Node::StrokeNode, color);
+	node.curve = curve;
+	node.style = style;
+	return add(node);
+}
+
+Scene::NodeId Scene::addRect(const Rect &rect, const Color &color)
+{
+	Node node(Node::RectNode, color);
+	node.rect = rect;
+	return add(node);
+}
+
+Scene::NodeId Scene::addPoint(const Point &point, const Color &color)
+{
+	Node node(Node::PointNode, color);
+	node.point = point;
+	return add(node);
+}
+
+void Scene::setCurve(NodeId id, const Bezier &curve)
+{
+	auto &node = nodes_[id];
+	if (node.kind != Node::CurveNode && node.kind != Node::StrokeNode) {
+		throw Error("Scene: setCurve on a node which is not a curve");
+	}
+	if (! sameControlPoints(node.curve, curve)) {
+		node.curve = curve;
+		node.polyline.reset();
+		index_.update(id, boundingBox(node));
+		dirty_ = true;
+	}
+}
+
+void Scene::setRect(NodeId id, const Rect &rect)
+{
+	auto &node = nodes_[id];
+	if (node.kind != Node::RectNode) {
+		throw Error("Scene: setRect on a node which is not a rectangle");
+	}
+	if (! sameRect(node.rect, rect)) {
+		node.rect = rect;
+		index_.update(id, boundingBox(node));
+		dirty_ = true;
+	}
+}
+
+void Scene::setPoint(NodeId id, const Point &point)
+{
+	auto &node = nodes_[id];
+	if (node.kind != Node::PointNode) {
+		throw Error("Scene: setPoint on a node which is not a point");
+	}
+	if (node.point != point) {
+		node.point = point;
+		index_.update(id, boundingBox(node));
+		dirty_ = true;
+	}
+}
+
+void Scene::setColor(NodeId id, const Color &color)
+{
+	auto &node = nodes_[id];
+	if (node.color != color) {
+		node.color = color;
+		dirty_ = true;
+	}
+}
+
+void Scene::setVisible(NodeId id, bool visible)
+{
+	auto &node = nodes_[id];
+	if (node.visible != visible) {
+		node.visible = visible;
+		dirty_ = true;
+	}
+}
+
+void Scene::setBackground(const Color &color)
+{
+	if (background_ != color) {
+		background_ = color;
+		dirty_ = true;
+	}
+}
+
+void Scene::setTessellationCache(std::shared_ptr<TessellationCache> cache)
+{
+	cache_ = cache;
+	for (auto &node: nodes_) {
+		node.polyline.reset();
+	}
+	dirty_ = true;
+}
+
+void Scene::setTransform(const Transform &t)
+{
+	if (t == transform_) return;
+
+	auto inverse = t.inverted();
+
+	if (! sameLinearPart(t, transform_)) {
+		for (auto &node: nodes_) {
+			node.polyline.reset();
+		}
+	}
+	transform_ = t;
+	inverse_ = inverse;
+	dirty_ = true;
+}
+
+const Transform & Scene::transform() const
+{
+	return transform_;
+}
+
+void Scene::setViewport(const Rect &viewport)
+{
+	if (! hasViewport_ || ! sameRect(viewport_, viewport)) {
+		viewport_ = viewport;
+		hasViewport_ = true;
+		dirty_ = true;
+	}
+}
+
+/// La recherche a lieu dans l'espace des noeuds; le rayon y est majore,
+/// les distances y sont exactes a une mise a l'echelle non uniforme pres.
+bool Scene::pick(const Point &p, real radius, NodeId &found)
+{
+	auto q = inverse_(p);
+	return index_.nearest(q, radius*inverse_.scale(), found, [&](SpatialIndex::Id id) {
+		auto &node = nodes_[id];
+		return node.visible
+			? distance(node, q)
+			: std::numeric_limits<real>::infinity();
+	});
+}
+
+bool Scene::dirty() const
+{
+	return dirty_;
+}
+
+void Scene::invalidate()
+{
+	dirty_ = true;
+}
+
+bool Scene::render(Painter &painter)
+{
+	if (! dirty_) {
+		return false;
+	}
+
+	painter.setDrawColor(background_);
+	painter.clear();
+
+	if (hasViewport_) {
+		// Les noeuds sont dessines dans leur ordre d'ajout.
+		visible_.clear();
+		index_.query(inverse_(viewport_), [&](SpatialIndex::Id id) {
+			visible_.push_back(id);
+		});
+		std::sort(visible_.begin(), visible_.end());
+		for (auto id: visible_) {
+			draw(painter, nodes_[id]);
+		}
+	} else {
+		for (auto &node: nodes_) {
+			draw(painter, node);
+		}
+	}
+
+	dirty_ = false;
+	return true;
+}
+
+void Scene::draw(Painter &painter, Node &node)
+{
+	if (! node.visible) return;
+
+	painter.setDrawColor(node.color);
+	if (node.kind == Node::CurveNode) {
+		// La tessellation est deja dans l'espace de l'affichage.
+		tessellate(node);
+		painter.drawPolyline(*node.polyline, transform_(node.curve.p1()));
+		return;
+	}
+
+	painter.save();
+	painter.apply(transform_);
+	switch (node.kind) {
+	case Node::StrokeNode:
+		painter.strokeCurve(node.curve, node.style, tolerance_);
+		break;
+
+	case Node::RectNode:
+		painter.drawRect(node.rect);
+		break;
+
+	case Node::PointNode:
+		painter.drawPoint(node.point);
+		break;
+
+	case Node::CurveNode:
+		break;
+	}
+	painter.restore();
+}
+
+void Scene::tessellate(Node &node)
+{
+	if (! node.polyline) {
+		auto curve = transform_.isIdentity() ? node.curve : transform_(node.curve);
+		node.polyline = cache_
+			? cache_->get(curve, tolerance_)
+			: TessellationCache::tessellate(curve, tolerance_);
+	}
+}
+
+/// Boite englobante d'un noeud, telle que dessinee (voir
+/// Painter::drawPoint() pour les points).
+Rect Scene::boundingBox(const Node &node) const
+{
+	switch (node.kind) {
+	case Node::CurveNode:
+		return node.curve.boudingBox();
+
+	case Node::StrokeNode: {
+		// Une terminaison carree deborde de la demi-epaisseur dans les
+		// deux directions.
+		auto half = node.style.width.maximum()/2;
+		auto margin = node.style.cap == LineCap::Square ? half*std::sqrt(real(2)) : half;
+		auto box = node.curve.boudingBox();
+		return Rect(box.topLeft() - Point{margin, margin}, box.bottomRight() + Point{margin, margin});
+	}
+
+	case Node::RectNode:
+		return node.rect;
+
+	case Node::PointNode:
+		break;
+	}
+	return Rect(node.point - Point{2, 2}, node.point + Point{2, 2});
+}
+
+/// Retourne la distance de p au segment [a, b].
+static real segmentDistance(const Point &p, const Point &a, const Point &b)
+{
+	auto ab = b - a, ap = p - a;
+	auto length = SQUARE(ab.x) + SQUARE(ab.y);
+	auto t = length > 0 ? (ap.x*ab.x + ap.y*ab.y)/length : 0;
+	auto q = a + ab*std::min(std::max(t, real(0)), real(1));
+	return std::sqrt(SQUARE(p.x - q.x) + SQUARE(p.y - q.y));
+}
+
+/// Distance de p au trace du noeud: distance exacte a la courbe (voir
+/// Bezier::project()), diminuee de la demi-epaisseur pour un trait plein,
+/// contour pour un rectangle.
+real Scene::distance(const Node &node, const Point &p) const
+{
+	switch (node.kind) {
+	case Node::CurveNode:
+		return node.curve.project(p).distance;
+
+	case Node::StrokeNode: {
+		auto projection = node.curve.project(p);
+		return std::max(projection.distance - node.style.width(projection.t)/2, real(0));
+	}
+
+	case Node::RectNode: {
+		auto &r = node.rect;
+		return std::min(
+			std::min(
+				segmentDistance(p, r.topLeft(), r.topRight()),
+				segmentDistance(p, r.topRight(), r.bottomRight())),
+			std::min(
+				segmentDistance(p, r.bottomRight(), r.bottomLeft()),
+				segmentDistance(p, r.bottomLeft(), r.topLeft()))
+		);
+	}
+
+	case Node::PointNode:
+		break;
+	}
+	return std::sqrt(SQUARE(p.x - node.point.x) + SQUARE(p.y - node.point.y));
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "bezier.h"
+#include "color.h"
+#include "common.h"
+#include "flatten.h"
+#include "point.h"
+#include "rect.h"
+#include "spatialindex.h"
+#include "stroker.h"
+#include "tessellationcache.h"
+#include "transform.h"
+
+#include <memory>
+#include <vector>
+
+namespace nealrame
+{
+class Painter;
+
+/// Scene retenue: les noeuds (courbes, rectangles, points) sont conserves
+/// d'une image a l'autre. Une courbe n'est re-tessellee que lorsque ses
+/// points de controle changent et la scene n'est redessinee que si un de
+/// ses noeuds a ete modifie. Les tessellations peuvent etre partagees avec
+/// d'autres scenes par l'intermediaire d'un TessellationCache. Les boites
+/// englobantes des noeuds sont indexees, ce qui permet d'ecarter les noeuds
+/// hors de la zone d'affichage et de retrouver le noeud sous le pointeur
+/// sans parcourir toute la scene.
+class Scene {
+public:
+	typedef std::vector<int>::size_type NodeId;
+
+public:
+	Scene(const Color &background = Color::Black, real tolerance = DefaultTolerance);
+
+	NodeId addCurve(const Bezier &, const Color &);
+
+	/// Ajoute une courbe dessinee comme un trait plein (voir Stroker).
+	NodeId addStroke(const Bezier &, const StrokeStyle &, const Color &);
+
+	NodeId addRect(const Rect &, const Color &);
+	NodeId addPoint(const Point &, const Color &);
+
+	/// Modifient la geometrie d'un noeud. Chaque methode leve une Error si
+	/// le noeud n'est pas du genre attendu (setCurve() vaut pour les
+	/// courbes et les traits).
+	void setCurve(NodeId, const Bezier &);
+	void setRect(NodeId, const Rect &);
+	void setPoint(NodeId, const Point &);
+	void setColor(NodeId, const Color &);
+	void setVisible(NodeId, bool);
+	void setBackground(const Color &);
+
+	/// Utilise le cache donne pour tesseller les courbes (aucun cache si
+	/// cache est nul).
+	void setTessellationCache(std::shared_ptr<TessellationCache> cache);
+
+	/// Transformation de vue, appliquee aux noeuds avant la transformation
+	/// du Painter. Les courbes sont tessellees dans l'espace de
+	/// l'affichage, relativement a leur premier point: un deplacement de la
+	/// vue conserve les tessellations, un changement d'echelle ou une
+	/// rotation les refait (au travers du cache) avec la tolerance de la
+	/// scene, exprimee en pixels. Leve une Error si la transformation n'est
+	/// pas inversible.
+	void setTransform(const Transform &);
+	const Transform & transform() const;
+
+	/// Limite le rendu aux noeuds intersectant viewport (dans l'espace de
+	/// l'affichage).
+	void setViewport(const Rect &viewport);
+
+	/// Recherche le noeud visible le plus proche de p, a une distance au
+	/// plus radius (dans l'espace de l'affichage). Retourne false si aucun
+	/// noeud n'est assez proche.
+	bool pick(const Point &p, real radius, NodeId &found);
+
+	/// Indique si la scene a change depuis le dernier rendu.
+	bool dirty() const;
+
+	/// Force le prochain rendu, par exemple lorsque le contenu de la
+	/// fenetre a ete perdu.
+	void invalidate();
+
+	/// Dessine la scene si elle a change depuis le dernier rendu. Retourne
+	/// false si rien n'a ete dessine, auquel cas il est inutile de
+	/// presenter l'image.
+	bool render(Painter &);
+
+private:
+	struct Node {
+		enum Kind {
+			CurveNode, StrokeNode, RectNode, PointNode
+		};
+
+		Node(Kind kind, const Color &color) :
+			kind(kind), color(color), visible(true)
+		{ }
+
+		Kind kind;
+		Color color;
+		Bezier curve;
+		StrokeStyle style;
+		Rect rect;
+		Point point;
+		TessellationCache::Entry polyline;
+		bool visible;
+	};
+
+	NodeId add(const Node &);
+	Rect boundingBox(const Node &) const;
+	real distance(const Node &, const Point &) const;
+	void tessellate(Node &);
+	void draw(Painter &, Node &);
+
+private:
+	std::vector<Node> nodes_;
+	std::shared_ptr<TessellationCache> cache_;
+	SpatialIndex index_;
+	std::vector<NodeId> visible_;
+	Color background_;
+	real tolerance_;
+	Transform transform_;
+	Transform inverse_;
+	Rect viewport_;
+	bool hasViewport_;
+	bool dirty_;
+};
+}
@@ -0,0 +1,160 @@
+#include "sdlbackend.h"
+
+#include "color.h"
+#include "error.h"
+#include "rasterizer.h"
+#include "rect.h"
+#include "window.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include <SDL.h>
+
+using namespace nealrame;
+
+struct SdlBackend::Impl {
+	Impl(std::shared_ptr<Window> window, SDL_Renderer *renderer) :
+		window(window),
+		renderer(renderer, SDL_DestroyRenderer)
+	{ }
+	std::shared_ptr<Window> window;
+	std::unique_ptr<SDL_Renderer, std::function<void(SDL_Renderer *)>> renderer;
+	std::vector<SDL_Point> points;
+	real width = 1;
+	EdgeList edges;
+	Rasterizer rasterizer;
+
+	bool fill(FillRule rule)
+	{ return fill(edges, rule); }
+
+	bool fill(const EdgeList &, FillRule);
+};
+
+/// SDL ne sait pas remplir de polygones: la couverture des segments est
+/// calculee par le Rasterizer et les suites de pixels couverts au moins a
+/// moitie sont tracees comme des segments horizontaux.
+bool SdlBackend::Impl::fill(const EdgeList &edges, FillRule rule)
+{
+	auto size = window->size();
+
+	if (rasterizer.width() != int(size.width) || rasterizer.height() != int(size.height)) {
+		rasterizer.resize(int(size.width), int(size.height));
+	}
+	rasterizer.add(edges);
+
+	auto ok = true;
+	rasterizer.sweep(rule, [&](int y, int x0, int x1, const real *coverage) {
+		for (auto x = x0; x < x1;) {
+			if (coverage[x - x0] < .5) {
+				++x;
+				continue;
+			}
+			auto end = x + 1;
+			while (end < x1 && coverage[end - x0] >= .5) ++end;
+			ok = SDL_RenderDrawLine(renderer.get(), x, y, end - 1, y) >= 0 && ok;
+			x = end;
+		}
+	});
+	return ok;
+}
+
+SdlBackend::SdlBackend(std::shared_ptr<Window> window) :
+	d_(new Impl(
+		window,
+		SDL_CreateRenderer(
+			static_cast<SDL_Window *>(window->get()), -1,
+			SDL_RENDERER_ACCELERATED|SDL_RENDERER_PRESENTVSYNC
+		)
+	))
+{
+	if (! d_->renderer) {
+		throw Error(SDL_GetError());
+	}
+}
+
+SdlBackend::~SdlBackend()
+{ }
+
+bool SdlBackend::clear()
+{
+	return SDL_RenderClear(d_->renderer.get()) >= 0;
+}
+
+bool SdlBackend::setDrawColor(const Color &c)
+{
+	return SDL_SetRenderDrawColor(
+		d_->renderer.get(), c.red, c.green, c.blue, c.alpha
+	) >= 0;
+}
+
+bool SdlBackend::setLineWidth(real width)
+{
+	if (width <= 0) return false;
+	d_->width = width;
+	return true;
+}
+
+/// Tous les segments de la ligne brisee, decales de offset, sont soumis en
+/// un seul appel a SDL_RenderDrawLines. SDL ne tracant que des lignes d'un
+/// pixel, les traits plus epais sont remplis comme des contours.
+bool SdlBackend::drawPolyline(const Polyline &polyline, const Point &offset)
+{
+	if (d_->width > 1) {
+		d_->edges.clear();
+		d_->edges.addStroke(polyline.data(), polyline.size(), d_->width, offset);
+		return d_->fill(FillRule::NonZero);
+	}
+
+	auto &points = d_->points;
+
+	points.resize(polyline.size());
+	std::transform(
+		polyline.begin(), polyline.end(), points.begin(),
+		[&](const Point &p) {
+			return SDL_Point{
+				int(std::lround(p.x + offset.x)),
+				int(std::lround(p.y + offset.y))
+			};
+		}
+	);
+
+	return SDL_RenderDrawLines(
+		d_->renderer.get(), points.data(), int(points.size())
+	) >= 0;
+}
+
+bool SdlBackend::drawRect(const Rect &r)
+{
+	SDL_Rect rect = { 
+		int16_t(r.topLeft().x),
+		int16_t(r.topLeft().y),
+		int16_t(r.width()),
+		int16_t(r.height())
+	};
+	return SDL_RenderDrawRect(d_->renderer.get(), &rect) >= 0;
+}
+
+bool SdlBackend::fill(const std::vector<Polyline> &contours, FillRule rule)
+{
+	auto &edges = d_->edges;
+
+	edges.clear();
+	for (auto &contour: contours) {
+		edges.addContour(contour.data(), contour.size());
+	}
+	return d_->fill(rule);
+}
+
+/// Les segments sont transmis directement au rasterizer, sans copie.
+bool SdlBackend::fill(const EdgeList &edges, FillRule rule)
+{
+	return d_->fill(edges, rule);
+}
+
+void SdlBackend::present()
+{
+	SDL_RenderPresent(d_->renderer.get());
+}
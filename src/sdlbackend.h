@@ -0,0 +1,31 @@
+#pragma once
+
+#include "backend.h"
+
+#include <memory>
+
+namespace nealrame
+{
+class Window;
+
+/// Implementation du dessin par un SDL_Renderer associe a une fenetre.
+class SdlBackend : public Backend {
+	PIMPL;
+
+	SdlBackend(const SdlBackend &) = delete;
+	SdlBackend & operator=(const SdlBackend &) = delete;
+
+public:
+	SdlBackend(std::shared_ptr<Window> window);
+	virtual ~SdlBackend();
+
+	virtual bool clear();
+	virtual bool setDrawColor(const Color &);
+	virtual bool setLineWidth(real width);
+	virtual bool drawPolyline(const Polyline &, const Point &offset);
+	virtual bool drawRect(const Rect &);
+	virtual bool fill(const std::vector<Polyline> &contours, FillRule);
+	virtual bool fill(const EdgeList &, FillRule);
+	virtual void present();
+};
+}
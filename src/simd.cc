@@ -0,0 +1,104 @@
+#include "simd.h"
+
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#	define NR_SIMD_X86
+#	include <immintrin.h>
+#endif
+
+using namespace nealrame;
+
+static_assert(std::is_same<real, float>::value, "SIMD kernels expect real = float");
+
+namespace
+{
+using Kernel = void (*)(const real *, unsigned int, const real *, std::size_t, real *);
+
+void hornerScalar(
+	const real *factors, unsigned int degree,
+	const real *xs, std::size_t count, real *out)
+{
+	for (std::size_t i = 0; i < count; ++i) {
+		auto x = xs[i];
+		auto v = factors[degree];
+		for (auto k = degree; k-- > 0;) {
+			v = v*x + factors[k];
+		}
+		out[i] = v;
+	}
+}
+
+#if defined(NR_SIMD_X86)
+__attribute__((target("sse")))
+void hornerSSE(
+	const real *factors, unsigned int degree,
+	const real *xs, std::size_t count, real *out)
+{
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		auto x = _mm_loadu_ps(xs + i);
+		auto v = _mm_set1_ps(factors[degree]);
+		for (auto k = degree; k-- > 0;) {
+			v = _mm_add_ps(_mm_mul_ps(v, x), _mm_set1_ps(factors[k]));
+		}
+		_mm_storeu_ps(out + i, v);
+	}
+	hornerScalar(factors, degree, xs + i, count - i, out + i);
+}
+
+__attribute__((target("avx")))
+void hornerAVX(
+	const real *factors, unsigned int degree,
+	const real *xs, std::size_t count, real *out)
+{
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		auto x = _mm256_loadu_ps(xs + i);
+		auto v = _mm256_set1_ps(factors[degree]);
+		for (auto k = degree; k-- > 0;) {
+			v = _mm256_add_ps(_mm256_mul_ps(v, x), _mm256_set1_ps(factors[k]));
+		}
+		_mm256_storeu_ps(out + i, v);
+	}
+	hornerSSE(factors, degree, xs + i, count - i, out + i);
+}
+#endif
+
+struct Selection {
+	Kernel kernel;
+	const char *name;
+};
+
+Selection select()
+{
+#if defined(NR_SIMD_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx")) {
+		return {hornerAVX, "avx"};
+	}
+	if (__builtin_cpu_supports("sse")) {
+		return {hornerSSE, "sse"};
+	}
+#endif
+	return {hornerScalar, "scalar"};
+}
+
+const Selection & selection()
+{
+	static const Selection selection_ = select();
+	return selection_;
+}
+}
+
+void simd::horner(
+	const real *factors, unsigned int degree,
+	const real *xs, std::size_t count, real *out)
+{
+	selection().kernel(factors, degree, xs, count, out);
+}
+
+const char * simd::kernelName()
+{
+	return selection().name;
+}
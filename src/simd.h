@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstddef>
+
+namespace nealrame
+{
+namespace simd
+{
+/// Evalue, par la methode de Horner, le polynome de degre degree dont les
+/// coefficients sont donnes par ordre de degre croissant, pour chacune des
+/// count valeurs de xs. Les resultats sont ecrits dans out.
+///
+/// L'implementation (AVX, SSE ou scalaire) est choisie a l'execution selon
+/// les capacites du processeur.
+void horner(
+	const real *factors, unsigned int degree,
+	const real *xs, std::size_t count, real *out);
+
+/// Retourne le nom de l'implementation selectionnee.
+const char * kernelName();
+}
+}
@@ -0,0 +1,369 @@
+#include "spatialindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace nealrame;
+
+static const int Null = -1;
+
+SpatialIndex::Box SpatialIndex::Box::of(const Rect &r)
+{
+	auto tl = r.topLeft(), br = r.bottomRight();
+	return {tl.x, tl.y, br.x, br.y};
+}
+
+SpatialIndex::Box SpatialIndex::Box::united(const Box &b) const
+{
+	return {
+		std::min(x0, b.x0), std::min(y0, b.y0),
+		std::max(x1, b.x1), std::max(y1, b.y1)
+	};
+}
+
+SpatialIndex::Box SpatialIndex::Box::expanded(real m) const
+{
+	return {x0 - m, y0 - m, x1 + m, y1 + m};
+}
+
+real SpatialIndex::Box::perimeter() const
+{
+	return 2*((x1 - x0) + (y1 - y0));
+}
+
+bool SpatialIndex::Box::contains(const Box &b) const
+{
+	return x0 <= b.x0 && y0 <= b.y0 && b.x1 <= x1 && b.y1 <= y1;
+}
+
+bool SpatialIndex::Box::intersects(const Box &b) const
+{
+	return x0 <= b.x1 && b.x0 <= x1 && y0 <= b.y1 && b.y0 <= y1;
+}
+
+real SpatialIndex::Box::distance(const Point &p) const
+{
+	auto dx = std::max(std::max(x0 - p.x, p.x - x1), real(0));
+	auto dy = std::max(std::max(y0 - p.y, p.y - y1), real(0));
+	return std::sqrt(SQUARE(dx) + SQUARE(dy));
+}
+
+SpatialIndex::SpatialIndex(real margin) :
+	root_(Null),
+	margin_(margin)
+{ }
+
+void SpatialIndex::insert(Id id, const Rect &rect)
+{
+	if (contains(id)) {
+		update(id, rect);
+		return;
+	}
+
+	auto leaf = allocate();
+	auto &node = nodes_[leaf];
+
+	node.exact = Box::of(rect);
+	node.box = node.exact.expanded(margin_);
+	node.id = id;
+
+	leaves_[id] = leaf;
+	insertLeaf(leaf);
+}
+
+void SpatialIndex::update(Id id, const Rect &rect)
+{
+	auto it = leaves_.find(id);
+	if (it == leaves_.end()) {
+		insert(id, rect);
+		return;
+	}
+
+	auto leaf = it->second;
+	auto exact = Box::of(rect);
+
+	nodes_[leaf].exact = exact;
+	if (nodes_[leaf].box.contains(exact)) {
+		return;
+	}
+
+	removeLeaf(leaf);
+	nodes_[leaf].box = exact.expanded(margin_);
+	insertLeaf(leaf);
+}
+
+void SpatialIndex::remove(Id id)
+{
+	auto it = leaves_.find(id);
+	if (it != leaves_.end()) {
+		removeLeaf(it->second);
+		release(it->second);
+		leaves_.erase(it);
+	}
+}
+
+bool SpatialIndex::contains(Id id) const
+{
+	return leaves_.count(id) > 0;
+}
+
+std::size_t SpatialIndex::size() const
+{
+	return leaves_.size();
+}
+
+void SpatialIndex::clear()
+{
+	nodes_.clear();
+	free_.clear();
+	leaves_.clear();
+	root_ = Null;
+}
+
+void SpatialIndex::query(const Rect &rect, const std::function<void(Id)> &visit) const
+{
+	if (root_ == Null) return;
+
+	auto box = Box::of(rect);
+	std::vector<int> stack(1, root_);
+
+	while (! stack.empty()) {
+		auto &node = nodes_[stack.back()];
+		stack.pop_back();
+
+		if (! node.box.intersects(box)) continue;
+
+		if (node.leaf()) {
+			if (node.exact.intersects(box)) {
+				visit(node.id);
+			}
+		} else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+}
+
+/// Parcours en profondeur, en visitant d'abord le fils le plus proche et
+/// en elaguant les sous-arbres dont la boite est plus loin que le meilleur
+/// candidat.
+bool SpatialIndex::nearest(
+	const Point &p, real radius, Id &found,
+	const std::function<real(Id)> &distance) const
+{
+	if (root_ == Null) return false;
+
+	auto best = radius;
+	auto hit = false;
+	std::vector<int> stack(1, root_);
+
+	while (! stack.empty()) {
+		auto index = stack.back();
+		stack.pop_back();
+
+		auto &node = nodes_[index];
+		if (node.box.distance(p) > best) continue;
+
+		if (node.leaf()) {
+			if (node.exact.distance(p) > best) continue;
+
+			auto d = distance ? distance(node.id) : node.exact.distance(p);
+			if (d <= best) {
+				best = d;
+				found = node.id;
+				hit = true;
+			}
+		} else {
+			auto l = node.left, r = node.right;
+			if (nodes_[l].box.distance(p) < nodes_[r].box.distance(p)) {
+				std::swap(l, r);
+			}
+			stack.push_back(l);
+			stack.push_back(r);
+		}
+	}
+	return hit;
+}
+
+int SpatialIndex::allocate()
+{
+	int index;
+	if (! free_.empty()) {
+		index = free_.back();
+		free_.pop_back();
+	} else {
+		index = int(nodes_.size());
+		nodes_.push_back(Node());
+	}
+
+	auto &node = nodes_[index];
+	node.parent = node.left = node.right = Null;
+	node.height = 0;
+	node.id = 0;
+	return index;
+}
+
+void SpatialIndex::release(int index)
+{
+	free_.push_back(index);
+}
+
+/// Descend depuis la racine en choisissant a chaque niveau le fils dont
+/// l'agrandissement (en perimetre) est le moindre, puis remplace la feuille
+/// atteinte par un noeud regroupant celle-ci et la nouvelle feuille.
+void SpatialIndex::insertLeaf(int leaf)
+{
+	if (root_ == Null) {
+		root_ = leaf;
+		nodes_[leaf].parent = Null;
+		return;
+	}
+
+	auto box = nodes_[leaf].box;
+	auto index = root_;
+
+	while (! nodes_[index].leaf()) {
+		auto &node = nodes_[index];
+		auto perimeter = node.box.perimeter();
+		auto combined = node.box.united(box).perimeter();
+
+		auto cost = 2*combined;
+		auto inheritance = 2*(combined - perimeter);
+
+		auto descent = [&](int child) {
+			auto &c = nodes_[child];
+			auto enlarged = c.box.united(box).perimeter();
+			return c.leaf()
+				? enlarged + inheritance
+				: enlarged - c.box.perimeter() + inheritance;
+		};
+
+		auto cost_left = descent(node.left);
+		auto cost_right = descent(node.right);
+
+		if (cost < cost_left && cost < cost_right) break;
+
+		index = cost_left < cost_right ? node.left : node.right;
+	}
+
+	auto sibling = index;
+	auto old_parent = nodes_[sibling].parent;
+	auto new_parent = allocate();
+
+	nodes_[new_parent].parent = old_parent;
+	nodes_[new_parent].box = nodes_[sibling].box.united(box);
+	nodes_[new_parent].height = nodes_[sibling].height + 1;
+	nodes_[new_parent].left = sibling;
+	nodes_[new_parent].right = leaf;
+	nodes_[sibling].parent = new_parent;
+	nodes_[leaf].parent = new_parent;
+
+	if (old_parent == Null) {
+		root_ = new_parent;
+	} else if (nodes_[old_parent].left == sibling) {
+		nodes_[old_parent].left = new_parent;
+	} else {
+		nodes_[old_parent].right = new_parent;
+	}
+
+	refit(nodes_[leaf].parent);
+}
+
+void SpatialIndex::removeLeaf(int leaf)
+{
+	if (leaf == root_) {
+		root_ = Null;
+		return;
+	}
+
+	auto parent = nodes_[leaf].parent;
+	auto grand_parent = nodes_[parent].parent;
+	auto sibling = nodes_[parent].left == leaf
+		? nodes_[parent].right
+		: nodes_[parent].left;
+
+	if (grand_parent == Null) {
+		root_ = sibling;
+		nodes_[sibling].parent = Null;
+		release(parent);
+		return;
+	}
+
+	if (nodes_[grand_parent].left == parent) {
+		nodes_[grand_parent].left = sibling;
+	} else {
+		nodes_[grand_parent].right = sibling;
+	}
+	nodes_[sibling].parent = grand_parent;
+	release(parent);
+
+	refit(grand_parent);
+}
+
+/// Remonte vers la racine en reequilibrant et en recalculant boites et
+/// hauteurs.
+void SpatialIndex::refit(int index)
+{
+	while (index != Null) {
+		index = balance(index);
+
+		auto &node = nodes_[index];
+		auto &l = nodes_[node.left], &r = nodes_[node.right];
+
+		node.height = 1 + std::max(l.height, r.height);
+		node.box = l.box.united(r.box);
+
+		index = node.parent;
+	}
+}
+
+/// Effectue une rotation si les hauteurs des fils du noeud a different de
+/// plus de 1. Retourne l'indice du noeud qui prend la place de a.
+int SpatialIndex::balance(int a)
+{
+	auto &A = nodes_[a];
+	if (A.leaf() || A.height < 2) {
+		return a;
+	}
+
+	auto b = A.left, c = A.right;
+	auto diff = nodes_[c].height - nodes_[b].height;
+
+	if (diff > 1 || diff < -1) {
+		// up est le fils le plus haut, il remonte a la place de a; other
+		// est l'autre fils de a.
+		auto up = diff > 1 ? c : b;
+		auto other = diff > 1 ? b : c;
+		auto &U = nodes_[up];
+		auto f = U.left, g = U.right;
+
+		U.parent = A.parent;
+		A.parent = up;
+
+		if (U.parent == Null) {
+			root_ = up;
+		} else if (nodes_[U.parent].left == a) {
+			nodes_[U.parent].left = up;
+		} else {
+			nodes_[U.parent].right = up;
+		}
+
+		// Le plus haut des fils de up reste sous up, l'autre passe sous a.
+		auto keep = nodes_[f].height > nodes_[g].height ? f : g;
+		auto move = keep == f ? g : f;
+
+		U.left = a;
+		U.right = keep;
+		A.left = other;
+		A.right = move;
+		nodes_[move].parent = a;
+
+		A.box = nodes_[other].box.united(nodes_[move].box);
+		A.height = 1 + std::max(nodes_[other].height, nodes_[move].height);
+		U.box = A.box.united(nodes_[keep].box);
+		U.height = 1 + std::max(A.height, nodes_[keep].height);
+
+		return up;
+	}
+	return a;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "common.h"
+#include "point.h"
+#include "rect.h"
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace nealrame
+{
+/// Index spatial sur des boites englobantes: arbre dynamique de boites
+/// (BVH) equilibre par rotations. Insertion, mise a jour et suppression
+/// sont en O(log n), de meme que la recherche des elements d'une zone ou
+/// de l'element le plus proche d'un point.
+///
+/// Les noeuds de l'arbre portent une boite elargie de margin: tant que la
+/// nouvelle boite d'un element reste dans sa boite elargie, update() ne
+/// modifie pas l'arbre.
+class SpatialIndex {
+public:
+	typedef std::size_t Id;
+
+public:
+	explicit SpatialIndex(real margin = 2);
+
+	void insert(Id, const Rect &);
+	void update(Id, const Rect &);
+	void remove(Id);
+	bool contains(Id) const;
+
+	std::size_t size() const;
+	void clear();
+
+	/// Appelle visit pour chaque element dont la boite intersecte rect.
+	void query(const Rect &, const std::function<void(Id)> &visit) const;
+
+	/// Recherche l'element le plus proche de p, a une distance au plus
+	/// radius. Si distance est fourni, il doit retourner la distance exacte
+	/// de p a l'element (minoree par la distance a sa boite); sinon, la
+	/// distance a la boite est utilisee. Retourne false si aucun element
+	/// n'est assez proche.
+	bool nearest(
+		const Point &p, real radius, Id &found,
+		const std::function<real(Id)> &distance = nullptr) const;
+
+private:
+	struct Box {
+		real x0, y0, x1, y1;
+
+		static Box of(const Rect &);
+		Box united(const Box &) const;
+		Box expanded(real) const;
+		real perimeter() const;
+		bool contains(const Box &) const;
+		bool intersects(const Box &) const;
+		real distance(const Point &) const;
+	};
+
+	struct Node {
+		Box box;
+		Box exact;
+		int parent;
+		int left, right;
+		int height;
+		Id id;
+
+		bool leaf() const
+		{ return left < 0; }
+	};
+
+	int allocate();
+	void release(int);
+	void insertLeaf(int);
+	void removeLeaf(int);
+	void refit(int);
+	int balance(int);
+
+private:
+	std::vector<Node> nodes_;
+	std::vector<int> free_;
+	std::unordered_map<Id, int> leaves_;
+	int root_;
+	real margin_;
+};
+}
@@ -0,0 +1,321 @@
+#include "stroker.h"
+
+#include "bezier.h"
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace nealrame;
+
+namespace
+{
+/// Nombre d'intervalles initiaux de chaque courbe, avant le decoupage
+/// adaptatif, et profondeur maximale de ce decoupage.
+const unsigned int InitialSegments = 4;
+const unsigned int MaxDepth = 10;
+
+/// Cosinus de l'angle maximal entre les normales aux bornes d'un intervalle.
+const real MinNormalCosine = .9f;
+
+/// Nombre maximal de points d'un arc (raccords et terminaisons arrondis).
+const std::size_t MaxArcPoints = 64;
+
+real dot(const Point &a, const Point &b)
+{ return a.x*b.x + a.y*b.y; }
+
+real cross(const Point &a, const Point &b)
+{ return a.x*b.y - a.y*b.x; }
+
+real norm(const Point &p)
+{ return std::sqrt(dot(p, p)); }
+
+/// Distance de p a la droite (a, b), ou a a si les points sont confondus.
+real chordDistance(const Point &p, const Point &a, const Point &b)
+{
+	auto d = b - a;
+	auto length = norm(d);
+	return length > 0 ? std::fabs(cross(d, p - a))/length : norm(p - a);
+}
+}
+
+real WidthProfile::maximum() const
+{
+	// Le maximum de la quadratique est atteint aux bornes ou, si middle
+	// depasse les deux extremites, au sommet de la parabole.
+	auto m = std::max(start, end);
+	auto a = start - 2*middle + end;
+	if (a < 0) {
+		auto s = (start - middle)/a;
+		if (s > 0 && s < 1) {
+			m = std::max(m, (*this)(s));
+		}
+	}
+	return m;
+}
+
+Stroker::Stroker(EdgeList &edges, real tolerance) :
+	edges_(edges),
+	tolerance_(tolerance > 0 ? tolerance : DefaultTolerance),
+	open_(false)
+{ }
+
+void Stroker::stroke(const Bezier &curve, const StrokeStyle &style)
+{
+	stroke(&curve, 1, style);
+}
+
+void Stroker::stroke(const Bezier *curves, std::size_t count, const StrokeStyle &style, bool closed)
+{
+	if (count == 0) return;
+
+	auto range = [&](std::size_t i, real &s0, real &s1) {
+		s0 = real(i)/count;
+		s1 = real(i + 1)/count;
+	};
+
+	for (std::size_t i = 0; i < count; ++i) {
+		real s0, s1;
+		range(i, s0, s1);
+
+		auto &c = curves[i];
+		auto first = sample(c, 0, s0, s1, style.width);
+		auto last = sample(c, 1, s0, s1, style.width);
+
+		curve(c, s0, s1, style.width);
+
+		// Debut de la courbe: raccord avec la precedente ou terminaison.
+		if (i > 0 && curves[i - 1].p2() == c.p1()) {
+			real p0, p1;
+			range(i - 1, p0, p1);
+			join(sample(curves[i - 1], 1, p0, p1, style.width), first, style);
+		} else if (! (closed && i == 0 && curves[count - 1].p2() == c.p1())) {
+			cap(first, true, style.cap);
+		}
+
+		// Fin de la courbe: le raccord est fait au debut de la suivante.
+		auto next = i + 1 < count ? &curves[i + 1] : closed ? &curves[0] : nullptr;
+		if (! next || next->p1() != c.p2()) {
+			cap(last, false, style.cap);
+		} else if (i + 1 == count) {
+			join(last, sample(curves[0], 0, 0, real(1)/count, style.width), style);
+		}
+	}
+}
+
+/// Aux extremites, la derivee s'annule si un point de controle est confondu
+/// avec l'extremite: la tangente est alors dirigee vers le point de
+/// controle distinct suivant. Ailleurs (point de rebroussement), elle est
+/// estimee par une difference centree.
+Stroker::Sample Stroker::sample(
+	const Bezier &c, real t, real s0, real s1, const WidthProfile &width) const
+{
+	auto d = c.derivative(t);
+
+	if (norm(d) <= 1e-6f) {
+		if (t <= 0) {
+			d = c.ctrl2() - c.p1();
+			if (norm(d) <= 1e-6f) d = c.p2() - c.p1();
+		} else if (t >= 1) {
+			d = c.p2() - c.ctrl1();
+			if (norm(d) <= 1e-6f) d = c.p2() - c.p1();
+		} else {
+			d = c(std::min(t + 1e-3f, real(1))) - c(std::max(t - 1e-3f, real(0)));
+		}
+	}
+
+	Sample s;
+	auto length = norm(d);
+	s.t = t;
+	s.center = c(t);
+	s.tangent = length > 0 ? d/length : Point{1, 0};
+	s.normal = {-s.tangent.y, s.tangent.x};
+	s.half = std::max(width(s0 + t*(s1 - s0)), real(0))/2;
+	s.plus = s.center + s.normal*s.half;
+	s.minus = s.center - s.normal*s.half;
+	return s;
+}
+
+void Stroker::curve(const Bezier &c, real s0, real s1, const WidthProfile &width)
+{
+	auto a = sample(c, 0, s0, s1, width);
+
+	for (unsigned int i = 1; i <= InitialSegments; ++i) {
+		auto b = sample(c, real(i)/InitialSegments, s0, s1, width);
+		subdivide(c, a, b, s0, s1, width, 0);
+		a = b;
+	}
+	close();
+}
+
+void Stroker::subdivide(
+	const Bezier &c, const Sample &a, const Sample &b, real s0, real s1,
+	const WidthProfile &width, unsigned int depth)
+{
+	if (depth < MaxDepth) {
+		auto m = sample(c, (a.t + b.t)/2, s0, s1, width);
+
+		if (dot(a.normal, b.normal) < MinNormalCosine
+				|| chordDistance(m.center, a.center, b.center) > tolerance_
+				|| chordDistance(m.plus, a.plus, b.plus) > tolerance_
+				|| chordDistance(m.minus, a.minus, b.minus) > tolerance_) {
+			subdivide(c, a, m, s0, s1, width, depth + 1);
+			subdivide(c, m, b, s0, s1, width, depth + 1);
+			return;
+		}
+	}
+	segment(a, b);
+}
+
+/// Tant que les deux bords avancent dans le sens de la courbe, seuls les
+/// bords sont emis et la piece reste ouverte; ses extremites sont fermees
+/// par close(). Sinon, l'intervalle est emis en quatre triangles autour du
+/// centre.
+void Stroker::segment(const Sample &a, const Sample &b)
+{
+	auto direction = b.center - a.center;
+
+	if (dot(b.plus - a.plus, direction) > 0 && dot(b.minus - a.minus, direction) > 0) {
+		if (! open_) {
+			edges_.addLine(a.minus, a.plus);
+			open_ = true;
+		}
+		edges_.addLine(a.plus, b.plus);
+		edges_.addLine(b.minus, a.minus);
+		last_ = b;
+		return;
+	}
+
+	close();
+
+	const Point triangles[][3] = {
+		{a.center, a.plus, b.plus},
+		{a.center, b.plus, b.center},
+		{a.center, b.center, b.minus},
+		{a.center, b.minus, a.minus}
+	};
+	for (auto &triangle: triangles) {
+		polygon(triangle, 3);
+	}
+}
+
+void Stroker::close()
+{
+	if (open_) {
+		edges_.addLine(last_.plus, last_.minus);
+		open_ = false;
+	}
+}
+
+/// Le raccord comble, du cote exterieur du virage, l'espace entre les bords
+/// des deux courbes; du cote interieur, les traits se recouvrent.
+void Stroker::join(const Sample &from, const Sample &to, const StrokeStyle &style)
+{
+	auto turn = cross(from.tangent, to.tangent);
+
+	if (std::fabs(turn) <= 1e-6f && dot(from.tangent, to.tangent) > 0) return;
+
+	auto side = turn > 0 ? real(-1) : real(1);
+	auto n0 = from.normal*side, n1 = to.normal*side;
+	auto center = to.center;
+	auto o0 = center + n0*from.half, o1 = center + n1*to.half;
+	auto half = std::max(from.half, to.half);
+
+	// La pointe est a half/cos(a/2) du centre, ou a est l'angle du virage
+	// et cos(a/2) = |n0 + n1|/2. Au-dela de la limite, le raccord est un
+	// biseau.
+	auto sum = n0 + n1;
+	auto length2 = dot(sum, sum);
+	auto type = style.join;
+	if (type == LineJoin::Miter && ! (length2 > 0 && 2/std::sqrt(length2) <= style.miterLimit)) {
+		type = LineJoin::Bevel;
+	}
+
+	switch (type) {
+	case LineJoin::Miter: {
+		const Point points[] = {center, o0, center + sum*(2*half/length2), o1};
+		polygon(points, 4);
+	} break;
+
+	case LineJoin::Bevel: {
+		const Point points[] = {center, o0, o1};
+		polygon(points, 3);
+	} break;
+
+	case LineJoin::Round: {
+		Point points[MaxArcPoints + 1];
+		std::size_t count = 0;
+		points[count++] = center;
+		arc(center, n0, std::atan2(cross(n0, n1), dot(n0, n1)), half, points, count);
+		polygon(points, count);
+	} break;
+	}
+}
+
+/// Une terminaison arrondie est un demi-disque; une terminaison carree
+/// prolonge le trait d'une demi-epaisseur.
+void Stroker::cap(const Sample &s, bool start, LineCap type)
+{
+	if (s.half <= 0) return;
+
+	auto outward = start ? -s.tangent : s.tangent;
+
+	switch (type) {
+	case LineCap::Butt:
+		break;
+
+	case LineCap::Square: {
+		auto extension = outward*s.half;
+		const Point points[] = {s.plus, s.minus, s.minus + extension, s.plus + extension};
+		polygon(points, 4);
+	} break;
+
+	case LineCap::Round: {
+		// De la normale, a travers outward, jusqu'a l'oppose de la normale.
+		Point points[MaxArcPoints];
+		std::size_t count = 0;
+		auto from = start ? s.normal : -s.normal;
+		arc(s.center, from, std::acos(-1.f), s.half, points, count);
+		polygon(points, count);
+	} break;
+	}
+}
+
+/// Ajoute a out les points de l'arc de cercle de centre center et de rayon
+/// radius partant de la direction unitaire from et tournant de angle. Le
+/// pas angulaire est tel que la corde s'ecarte de l'arc d'au plus la
+/// tolerance.
+void Stroker::arc(
+	const Point &center, const Point &from, real angle, real radius,
+	Point *out, std::size_t &count) const
+{
+	auto step = radius > tolerance_
+		? 2*std::acos(1 - tolerance_/radius)
+		: std::fabs(angle);
+	auto n = std::size_t(std::ceil(std::fabs(angle)/std::max(step, real(1e-3))));
+	n = std::min(std::max(n, std::size_t(1)), MaxArcPoints - 2);
+
+	for (std::size_t i = 0; i <= n; ++i) {
+		auto a = angle*i/n;
+		auto c = std::cos(a), s = std::sin(a);
+		out[count++] = center + Point{from.x*c - from.y*s, from.x*s + from.y*c}*radius;
+	}
+}
+
+/// Ajoute le contour ferme du polygone, oriente comme les bords du trait
+/// (aire signee negative). Un polygone d'aire nulle est ignore.
+void Stroker::polygon(const Point *points, std::size_t count)
+{
+	real area = 0;
+	for (std::size_t i = 0; i < count; ++i) {
+		area += cross(points[i], points[(i + 1)%count]);
+	}
+
+	if (area < 0) {
+		edges_.addContour(points, count);
+	} else if (area > 0) {
+		for (std::size_t i = count; i > 0; --i) {
+			edges_.addLine(points[i%count], points[i - 1]);
+		}
+	}
+}
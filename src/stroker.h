@@ -0,0 +1,122 @@
+#pragma once
+
+#include "common.h"
+#include "flatten.h"
+#include "point.h"
+
+#include <cstddef>
+
+namespace nealrame
+{
+class Bezier;
+class EdgeList;
+
+/// Raccord entre deux courbes consecutives d'un trait.
+enum class LineJoin {
+	Miter, Round, Bevel
+};
+
+/// Terminaison des extremites d'un trait ouvert.
+enum class LineCap {
+	Butt, Round, Square
+};
+
+/// Epaisseur d'un trait le long de son parcours s (de 0 a 1): courbe de
+/// Bezier quadratique des epaisseurs start, middle et end,
+///     w(s) = start*(1 - s)^2 + 2*middle*s*(1 - s) + end*s^2
+/// Pour une suite de n courbes, la courbe i parcourt [i/n, (i + 1)/n].
+struct WidthProfile {
+	WidthProfile(real width = 1) :
+		start(width), middle(width), end(width)
+	{ }
+
+	WidthProfile(real start, real middle, real end) :
+		start(start), middle(middle), end(end)
+	{ }
+
+	real operator()(real s) const
+	{ return start*SQUARE(1 - s) + 2*middle*s*(1 - s) + end*SQUARE(s); }
+
+	/// Retourne la plus grande epaisseur du profil.
+	real maximum() const;
+
+	real start, middle, end;
+};
+
+/// Style d'un trait: profil d'epaisseur, raccords et terminaisons. Un
+/// raccord en pointe (Miter) dont la longueur depasse miterLimit fois
+/// l'epaisseur est remplace par un biseau.
+struct StrokeStyle {
+	StrokeStyle(
+		const WidthProfile &width = WidthProfile(),
+		LineJoin join = LineJoin::Round, LineCap cap = LineCap::Butt,
+		real miterLimit = 4) :
+		width(width), join(join), cap(cap), miterLimit(miterLimit)
+	{ }
+
+	WidthProfile width;
+	LineJoin join;
+	LineCap cap;
+	real miterLimit;
+};
+
+/// Transforme des courbes (lignes medianes) en contours a remplir, ajoutes
+/// directement a une EdgeList.
+///
+/// Chaque courbe est decoupee adaptativement: un intervalle [t0, t1] est
+/// coupe en deux tant que la courbe ou l'une de ses deux courbes decalees
+/// (de +-w/2 selon la normale) s'ecarte de plus de tolerance de sa corde,
+/// ou que la normale tourne de plus de 25 degres. Chaque intervalle
+/// retenu donne un quadrilatere; les quadrilateres consecutifs partagent
+/// leurs cotes, qui ne sont pas emis: seuls les deux bords du trait le
+/// sont. La ou le bord interieur recule (rayon de courbure inferieur a la
+/// demi-epaisseur), l'intervalle est emis en triangles.
+///
+/// Toutes les pieces (bords, triangles, raccords, terminaisons) ont la
+/// meme orientation que celles d'EdgeList::addStroke(): leur union est
+/// correctement remplie avec la regle FillRule::NonZero. Aucune memoire
+/// n'est allouee en dehors de l'EdgeList.
+class Stroker {
+public:
+	Stroker(EdgeList &edges, real tolerance = DefaultTolerance);
+
+	/// Ajoute le trait de la courbe.
+	void stroke(const Bezier &, const StrokeStyle &);
+
+	/// Ajoute le trait de la suite de count courbes. Deux courbes
+	/// consecutives dont les extremites coincident sont raccordees (ainsi
+	/// que la derniere et la premiere si closed est vrai); sinon, le trait
+	/// est interrompu et ses extremites terminees.
+	void stroke(const Bezier *curves, std::size_t count, const StrokeStyle &, bool closed = false);
+
+private:
+	/// Point du trait: centre, normale unitaire et demi-epaisseur, et les
+	/// deux points du bord correspondants.
+	struct Sample {
+		real t;
+		Point center, tangent, normal;
+		real half;
+		Point plus, minus;
+	};
+
+	Sample sample(const Bezier &, real t, real s0, real s1, const WidthProfile &) const;
+
+	void curve(const Bezier &, real s0, real s1, const WidthProfile &);
+	void subdivide(
+		const Bezier &, const Sample &, const Sample &, real s0, real s1,
+		const WidthProfile &, unsigned int depth);
+	void segment(const Sample &, const Sample &);
+	void close();
+
+	void join(const Sample &from, const Sample &to, const StrokeStyle &);
+	void cap(const Sample &, bool start, LineCap);
+	void arc(const Point &center, const Point &from, real angle, real radius, Point *out, std::size_t &count) const;
+	void polygon(const Point *points, std::size_t count);
+
+private:
+	EdgeList &edges_;
+	real tolerance_;
+	bool open_;
+	Sample last_;
+};
+}
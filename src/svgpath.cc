@@ -0,0 +1,527 @@
+#include "svgpath.h"
+
+#include "error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+
+#include <boost/format.hpp>
+
+using namespace nealrame;
+
+namespace
+{
+/// Nombre d'arguments de chaque commande.
+unsigned int arity(char command)
+{
+	switch (command) {
+	case 'M': case 'm': case 'L': case 'l': case 'T': case 't':
+		return 2;
+	case 'H': case 'h': case 'V': case 'v':
+		return 1;
+	case 'C': case 'c':
+		return 6;
+	case 'S': case 's': case 'Q': case 'q':
+		return 4;
+	case 'A': case 'a':
+		return 7;
+	default:
+		return 0;
+	}
+}
+
+bool isCommand(char c)
+{
+	switch (c) {
+	case 'M': case 'm': case 'L': case 'l': case 'H': case 'h':
+	case 'V': case 'v': case 'C': case 'c': case 'S': case 's':
+	case 'Q': case 'q': case 'T': case 't': case 'A': case 'a':
+	case 'Z': case 'z':
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/// Retourne 10^e.
+double power10(int e)
+{
+	static const double exact[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	if (e >= 0 && e <= 22) return exact[e];
+	if (e < 0 && e >= -22) return 1/exact[-e];
+	return std::pow(10., e);
+}
+}
+
+SvgPathParser::SvgPathParser(CurveBatch &curves, std::vector<CurveBatch::size_type> *subpaths) :
+	curves_(curves),
+	subpaths_(subpaths),
+	offset_(0)
+{
+	reset();
+}
+
+void SvgPathParser::feed(const char *data, std::size_t size)
+{
+	for (auto end = data + size; data < end;) {
+		if (number_ != NoNumber) {
+			data = scanNumber(data, end);
+		} else {
+			start(*data++);
+			++offset_;
+		}
+	}
+}
+
+void SvgPathParser::finish()
+{
+	if (number_ != NoNumber) {
+		endNumber();
+	}
+	if (count_ != 0 || pending_) {
+		fail("missing arguments");
+	}
+	reset();
+}
+
+void SvgPathParser::reset()
+{
+	number_ = NoNumber;
+	command_ = previous_ = 0;
+	count_ = 0;
+	pending_ = false;
+	current_ = start_ = control_ = Point{0, 0};
+	open_ = false;
+}
+
+void SvgPathParser::parse(
+	const std::string &data, CurveBatch &curves,
+	std::vector<CurveBatch::size_type> *subpaths)
+{
+	SvgPathParser parser(curves, subpaths);
+	parser.feed(data.data(), data.size());
+	parser.finish();
+}
+
+void SvgPathParser::parse(
+	std::istream &in, CurveBatch &curves,
+	std::vector<CurveBatch::size_type> *subpaths)
+{
+	SvgPathParser parser(curves, subpaths);
+	char buffer[64*1024];
+
+	while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+		parser.feed(buffer, std::size_t(in.gcount()));
+	}
+	if (in.bad()) {
+		throw Error("SvgPathParser: read error");
+	}
+	parser.finish();
+}
+
+/// Traite un caractere hors d'un nombre.
+void SvgPathParser::start(char c)
+{
+	switch (c) {
+	case ' ': case '\t': case '\n': case '\r': case '\f': case ',':
+		return;
+	}
+
+	if (isCommand(c)) {
+		command(c);
+		return;
+	}
+
+	if (! isDigit(c) && c != '.' && c != '+' && c != '-') {
+		fail(std::string("unexpected character '") + c + "'");
+	}
+	if (command_ == 0) {
+		fail("expected a command");
+	}
+
+	// Les drapeaux des arcs tiennent en un caractere et peuvent ne pas etre
+	// separes de ce qui les suit ("a1 1 0 00 10 10").
+	if ((command_ == 'A' || command_ == 'a') && (count_ == 3 || count_ == 4)) {
+		if (c != '0' && c != '1') {
+			fail("expected a flag");
+		}
+		argument(c - '0');
+		return;
+	}
+
+	number_ = Integer;
+	negative_ = c == '-';
+	digits_ = false;
+	mantissa_ = 0;
+	scale_ = exponent_ = 0;
+	exponentNegative_ = false;
+
+	if (c == '+' || c == '-') {
+		number_ = Sign;
+	} else if (c == '.') {
+		number_ = Fraction;
+	} else {
+		mantissa_ = uint64_t(c - '0');
+		digits_ = true;
+	}
+}
+
+/// Poursuit la lecture du nombre en cours a partir de data. Retourne la
+/// position du premier caractere n'en faisant pas partie (le nombre est
+/// alors termine) ou end si le nombre peut se poursuivre dans le morceau
+/// suivant. L'etat est garde dans des variables locales le temps de la
+/// boucle.
+const char * SvgPathParser::scanNumber(const char *data, const char *end)
+{
+	// Au-dela de 18 chiffres significatifs, les chiffres suivants sont
+	// ignores (la precision d'un double est deja depassee).
+	const uint64_t limit = 100000000000000000ull;
+
+	auto state = number_;
+	auto mantissa = mantissa_;
+	auto scale = scale_, exponent = exponent_;
+	auto digits = digits_;
+	auto done = false;
+
+	for (; data < end && ! done; ++data, ++offset_) {
+		auto c = *data;
+
+		switch (state) {
+		case Sign:
+		case Integer:
+			if (isDigit(c)) {
+				if (mantissa < limit) {
+					mantissa = 10*mantissa + uint64_t(c - '0');
+				} else {
+					++scale;
+				}
+				digits = true;
+				state = Integer;
+			} else if (c == '.') {
+				state = Fraction;
+			} else if ((c == 'e' || c == 'E') && digits) {
+				state = Exponent;
+			} else {
+				done = true;
+			}
+			break;
+
+		case Fraction:
+			if (isDigit(c)) {
+				if (mantissa < limit) {
+					mantissa = 10*mantissa + uint64_t(c - '0');
+					--scale;
+				}
+				digits = true;
+			} else if ((c == 'e' || c == 'E') && digits) {
+				state = Exponent;
+			} else {
+				done = true;
+			}
+			break;
+
+		case Exponent:
+			if (c == '+' || c == '-') {
+				exponentNegative_ = c == '-';
+				state = ExponentSign;
+				break;
+			}
+			// fallthrough
+		case ExponentSign:
+			if (! isDigit(c)) {
+				fail("malformed exponent");
+			}
+			// fallthrough
+		case ExponentDigits:
+			if (isDigit(c)) {
+				exponent = std::min(10*exponent + (c - '0'), 1000);
+				state = ExponentDigits;
+			} else {
+				done = true;
+			}
+			break;
+
+		case NoNumber:
+			done = true;
+			break;
+		}
+	}
+
+	number_ = state;
+	mantissa_ = mantissa;
+	scale_ = scale;
+	exponent_ = exponent;
+	digits_ = digits;
+
+	if (done) {
+		// Le caractere ayant termine le nombre reste a traiter.
+		--data;
+		--offset_;
+		endNumber();
+	}
+	return data;
+}
+
+void SvgPathParser::endNumber()
+{
+	if (! digits_) {
+		fail("malformed number");
+	}
+	if (number_ == Exponent || number_ == ExponentSign) {
+		// Nombre interrompu dans son exposant (fin des donnees).
+		fail("malformed exponent");
+	}
+
+	auto value = double(mantissa_)*power10(scale_ + (exponentNegative_ ? -exponent_ : exponent_));
+
+	number_ = NoNumber;
+	argument(real(negative_ ? -value : value));
+}
+
+/// Ajoute un argument a la commande en cours, qui est executee des qu'elle
+/// a tous ses arguments. Les arguments suivants repetent la commande (une
+/// ligne apres un deplacement).
+void SvgPathParser::argument(real value)
+{
+	auto n = arity(command_);
+
+	if (n == 0) {
+		fail("unexpected number");
+	}
+
+	arguments_[count_++] = value;
+	pending_ = false;
+
+	if (count_ == n) {
+		count_ = 0;
+		execute();
+		if (command_ == 'M') {
+			command_ = 'L';
+		} else if (command_ == 'm') {
+			command_ = 'l';
+		}
+	}
+}
+
+void SvgPathParser::command(char c)
+{
+	if (count_ != 0 || pending_) {
+		fail("missing arguments");
+	}
+	if (command_ == 0 && c != 'M' && c != 'm') {
+		fail("a path must start with a move");
+	}
+
+	command_ = c;
+	pending_ = arity(c) > 0;
+	if (! pending_) {
+		execute();
+	}
+}
+
+void SvgPathParser::execute()
+{
+	auto a = arguments_;
+	auto relative = command_ >= 'a';
+	auto origin = relative ? current_ : Point{0, 0};
+	auto point = [&](unsigned int i) {
+		return Point{a[i], a[i + 1]} + origin;
+	};
+
+	// Reflexion du dernier point de controle pour S et T, s'il provient
+	// d'une commande de la meme famille.
+	auto reflected = [&](char cubic, char quadratic) {
+		return previous_ == cubic || previous_ == quadratic
+			? current_*2 - control_
+			: current_;
+	};
+
+	auto command = char(relative ? command_ - 'a' + 'A' : command_);
+
+	switch (command) {
+	case 'M':
+		moveTo(point(0));
+		break;
+
+	case 'L':
+		lineTo(point(0));
+		break;
+
+	case 'H':
+		lineTo({relative ? current_.x + a[0] : a[0], current_.y});
+		break;
+
+	case 'V':
+		lineTo({current_.x, relative ? current_.y + a[0] : a[0]});
+		break;
+
+	case 'C':
+		cubicTo(point(0), point(2), point(4));
+		break;
+
+	case 'S':
+		cubicTo(reflected('C', 'S'), point(0), point(2));
+		break;
+
+	case 'Q':
+	case 'T': {
+		auto q = command == 'Q' ? point(0) : reflected('Q', 'T');
+		auto p = command == 'Q' ? point(2) : point(0);
+		auto p0 = current_;
+
+		// Elevation de degre: les points de controle de la cubique sont aux
+		// deux tiers des segments joignant les extremites au controle.
+		cubicTo(p0 + (q - p0)*(real(2)/3), p + (q - p)*(real(2)/3), p);
+		control_ = q;
+	} break;
+
+	case 'A':
+		arcTo(a[0], a[1], a[2], a[3] != 0, a[4] != 0, point(5));
+		break;
+
+	case 'Z':
+		close();
+		break;
+	}
+
+	previous_ = command;
+}
+
+void SvgPathParser::moveTo(const Point &p)
+{
+	current_ = start_ = p;
+	open_ = false;
+}
+
+void SvgPathParser::lineTo(const Point &p)
+{
+	auto p0 = current_;
+
+	beginSegment();
+	curves_.push_back(p0, p0 + (p - p0)*(real(1)/3), p0 + (p - p0)*(real(2)/3), p);
+	current_ = p;
+}
+
+void SvgPathParser::cubicTo(const Point &c1, const Point &c2, const Point &p)
+{
+	beginSegment();
+	curves_.push_back(current_, c1, c2, p);
+	current_ = p;
+	control_ = c2;
+}
+
+/// Conversion de la parametrisation par les extremites a la
+/// parametrisation par le centre, suivant l'annexe F.6 de la norme SVG 1.1,
+/// puis approximation de chaque quart d'arc au plus par une cubique dont
+/// les tangentes aux extremites sont celles de l'ellipse, de longueur
+/// 4/3*tan(d/4) pour un arc d'angle d.
+void SvgPathParser::arcTo(real rx, real ry, real angle, bool largeArc, bool sweep, const Point &p)
+{
+	auto p0 = current_;
+
+	if (p0 == p) return;
+
+	double a = std::fabs(rx), b = std::fabs(ry);
+	if (a == 0 || b == 0) {
+		lineTo(p);
+		return;
+	}
+
+	const double pi = std::acos(-1.);
+	auto phi = angle*pi/180;
+	auto cosPhi = std::cos(phi), sinPhi = std::sin(phi);
+
+	auto dx = (double(p0.x) - p.x)/2, dy = (double(p0.y) - p.y)/2;
+	auto x1 = cosPhi*dx + sinPhi*dy;
+	auto y1 = -sinPhi*dx + cosPhi*dy;
+
+	// Agrandit les rayons s'ils ne permettent pas de joindre les extremites.
+	auto lambda = SQUARE(x1)/SQUARE(a) + SQUARE(y1)/SQUARE(b);
+	if (lambda > 1) {
+		a *= std::sqrt(lambda);
+		b *= std::sqrt(lambda);
+	}
+
+	auto num = SQUARE(a)*SQUARE(b) - SQUARE(a)*SQUARE(y1) - SQUARE(b)*SQUARE(x1);
+	auto den = SQUARE(a)*SQUARE(y1) + SQUARE(b)*SQUARE(x1);
+	auto coef = std::sqrt(std::max(num/den, 0.))*(largeArc == sweep ? -1 : 1);
+	auto cx1 = coef*a*y1/b, cy1 = -coef*b*x1/a;
+	auto cx = cosPhi*cx1 - sinPhi*cy1 + (double(p0.x) + p.x)/2;
+	auto cy = sinPhi*cx1 + cosPhi*cy1 + (double(p0.y) + p.y)/2;
+
+	auto vectorAngle = [](double ux, double uy, double vx, double vy) {
+		return std::atan2(ux*vy - uy*vx, ux*vx + uy*vy);
+	};
+	auto ux = (x1 - cx1)/a, uy = (y1 - cy1)/b;
+	auto theta = vectorAngle(1, 0, ux, uy);
+	auto delta = vectorAngle(ux, uy, (-x1 - cx1)/a, (-y1 - cy1)/b);
+
+	if (! sweep && delta > 0) {
+		delta -= 2*pi;
+	} else if (sweep && delta < 0) {
+		delta += 2*pi;
+	}
+
+	auto segments = std::max(int(std::ceil(std::fabs(delta)/(pi/2) - 1e-7)), 1);
+	auto step = delta/segments;
+	auto k = 4./3*std::tan(step/4);
+
+	auto ellipse = [&](double cosT, double sinT) {
+		return Point{
+			real(cx + a*cosT*cosPhi - b*sinT*sinPhi),
+			real(cy + a*cosT*sinPhi + b*sinT*cosPhi)
+		};
+	};
+	auto tangent = [&](double cosT, double sinT) {
+		return Point{
+			real(k*(-a*sinT*cosPhi - b*cosT*sinPhi)),
+			real(k*(-a*sinT*sinPhi + b*cosT*cosPhi))
+		};
+	};
+
+	auto cos0 = std::cos(theta), sin0 = std::sin(theta);
+
+	for (int i = 0; i < segments; ++i) {
+		auto t1 = theta + (i + 1)*step;
+		auto cos1 = std::cos(t1), sin1 = std::sin(t1);
+		auto end = i + 1 == segments ? p : ellipse(cos1, sin1);
+
+		cubicTo(current_ + tangent(cos0, sin0), end - tangent(cos1, sin1), end);
+		cos0 = cos1;
+		sin0 = sin1;
+	}
+}
+
+void SvgPathParser::close()
+{
+	if (open_ && current_ != start_) {
+		lineTo(start_);
+	}
+	current_ = start_;
+	open_ = false;
+}
+
+/// Enregistre le debut d'un sous-chemin a son premier segment.
+void SvgPathParser::beginSegment()
+{
+	if (! open_) {
+		if (subpaths_) {
+			subpaths_->push_back(curves_.size());
+		}
+		open_ = true;
+	}
+}
+
+void SvgPathParser::fail(const std::string &message) const
+{
+	throw Error((boost::format("SvgPathParser: %1% at offset %2%") % message % offset_).str());
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "common.h"
+#include "curvebatch.h"
+#include "point.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace nealrame
+{
+/// Lecteur incremental de donnees de chemin SVG (attribut d d'un element
+/// path: commandes M, L, H, V, C, S, Q, T, A et Z, absolues ou relatives).
+///
+/// Les donnees sont fournies par morceaux de taille quelconque a feed():
+/// l'etat du lecteur se limite a la commande et au nombre en cours, si bien
+/// que la memoire utilisee ne depend pas de la taille des donnees. Les
+/// nombres sont convertis au fil de la lecture, sans tampon ni strtod().
+///
+/// Tous les segments sont ajoutes au lot sous forme de cubiques: les
+/// segments de droite ont leurs points de controle aux tiers, les
+/// quadratiques sont elevees au degre 3 (de facon exacte) et les arcs
+/// d'ellipse sont decoupes en arcs d'au plus 90 degres, chacun approche
+/// par une cubique (erreur relative au rayon inferieure a 3e-4).
+class SvgPathParser {
+public:
+	/// Les courbes sont ajoutees a la fin de curves. Si subpaths n'est pas
+	/// nul, l'indice dans curves de la premiere courbe de chaque sous-chemin
+	/// y est ajoute.
+	SvgPathParser(CurveBatch &curves, std::vector<CurveBatch::size_type> *subpaths = nullptr);
+
+	/// Lit size octets de donnees. Leve une Error si elles sont mal formees.
+	void feed(const char *data, std::size_t size);
+
+	/// Termine la lecture. Leve une Error si les donnees sont incompletes.
+	/// Le lecteur peut ensuite lire un nouveau chemin.
+	void finish();
+
+	/// Lit un chemin complet.
+	static void parse(
+		const std::string &data, CurveBatch &curves,
+		std::vector<CurveBatch::size_type> *subpaths = nullptr);
+
+	/// Lit un chemin complet depuis in, par blocs de taille fixe.
+	static void parse(
+		std::istream &in, CurveBatch &curves,
+		std::vector<CurveBatch::size_type> *subpaths = nullptr);
+
+private:
+	enum NumberState {
+		NoNumber, Sign, Integer, Fraction, Exponent, ExponentSign, ExponentDigits
+	};
+
+	void reset();
+	void start(char);
+	const char * scanNumber(const char *data, const char *end);
+	void endNumber();
+	void argument(real);
+	void command(char);
+	void execute();
+
+	void moveTo(const Point &);
+	void lineTo(const Point &);
+	void cubicTo(const Point &, const Point &, const Point &);
+	void arcTo(real rx, real ry, real angle, bool largeArc, bool sweep, const Point &);
+	void close();
+	void beginSegment();
+
+	void fail(const std::string &message) const;
+
+private:
+	CurveBatch &curves_;
+	std::vector<CurveBatch::size_type> *subpaths_;
+	unsigned long offset_;
+
+	// Nombre en cours de lecture: mantissa_*10^(scale_ + exponent_).
+	NumberState number_;
+	bool negative_, digits_, exponentNegative_;
+	uint64_t mantissa_;
+	int scale_, exponent_;
+
+	// Commande en cours et ses arguments. pending_ indique qu'une commande
+	// vient d'etre lue et attend encore ses premiers arguments.
+	char command_, previous_;
+	real arguments_[7];
+	unsigned int count_;
+	bool pending_;
+
+	Point current_, start_, control_;
+	bool open_;
+};
+}
@@ -0,0 +1,135 @@
+#include "tessellationcache.h"
+
+#include "bezier.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace nealrame;
+
+bool TessellationCache::Key::operator==(const Key &rhs) const
+{
+	return std::equal(coordinates, coordinates + 6, rhs.coordinates)
+		&& tolerance == rhs.tolerance;
+}
+
+/// Combine les representations binaires des champs de la cle (FNV-1a).
+std::size_t TessellationCache::KeyHash::operator()(const Key &key) const
+{
+	uint32_t words[7];
+
+	std::memcpy(words, key.coordinates, sizeof(key.coordinates));
+	std::memcpy(words + 6, &key.tolerance, sizeof(key.tolerance));
+
+	uint64_t hash = 14695981039346656037ull;
+	for (auto word: words) {
+		hash = (hash ^ word)*1099511628211ull;
+	}
+	return std::size_t(hash);
+}
+
+TessellationCache::TessellationCache(std::size_t capacity) :
+	capacity_(capacity),
+	memory_(0),
+	hits_(0),
+	misses_(0)
+{ }
+
+TessellationCache::Entry
+TessellationCache::get(const Bezier &c, real tolerance)
+{
+	auto origin = c.p1();
+	const Point relative[] = {c.ctrl1() - origin, c.ctrl2() - origin, c.p2() - origin};
+
+	Key key;
+	for (unsigned int i = 0; i < 3; ++i) {
+		// Ajouter 0 ramene -0 a +0 pour que les deux zeros donnent la
+		// meme cle.
+		key.coordinates[2*i] = relative[i].x + real(0);
+		key.coordinates[2*i + 1] = relative[i].y + real(0);
+	}
+	key.tolerance = tolerance;
+
+	auto it = index_.find(key);
+	if (it != index_.end()) {
+		++hits_;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return it->second->second;
+	}
+
+	++misses_;
+
+	auto entry = tessellate(c, tolerance);
+
+	entries_.emplace_front(key, entry);
+	index_.emplace(key, entries_.begin());
+	memory_ += footprint(entry);
+	evict();
+
+	return entry;
+}
+
+TessellationCache::Entry TessellationCache::tessellate(const Bezier &c, real tolerance)
+{
+	auto origin = c.p1();
+	auto polyline = std::make_shared<Polyline>();
+
+	flatten(
+		Bezier(Point{0, 0}, c.ctrl1() - origin, c.ctrl2() - origin, c.p2() - origin),
+		*polyline, tolerance
+	);
+	polyline->shrink_to_fit();
+
+	return polyline;
+}
+
+std::size_t TessellationCache::size() const
+{ return index_.size(); }
+
+std::size_t TessellationCache::memory() const
+{ return memory_; }
+
+std::size_t TessellationCache::capacity() const
+{ return capacity_; }
+
+void TessellationCache::setCapacity(std::size_t capacity)
+{
+	capacity_ = capacity;
+	evict();
+}
+
+unsigned long TessellationCache::hits() const
+{ return hits_; }
+
+unsigned long TessellationCache::misses() const
+{ return misses_; }
+
+void TessellationCache::clear()
+{
+	index_.clear();
+	entries_.clear();
+	memory_ = 0;
+}
+
+/// Estimation de la memoire occupee par une entree: les points de la ligne
+/// brisee plus les structures du cache qui la referencent.
+std::size_t TessellationCache::footprint(const Entry &entry)
+{
+	return entry->capacity()*sizeof(Point)
+		+ sizeof(Polyline)
+		+ sizeof(List::value_type) + 2*sizeof(void *)
+		+ sizeof(Key) + sizeof(List::iterator) + sizeof(void *);
+}
+
+/// Retire les entrees les moins recemment utilisees jusqu'a ce que la
+/// memoire occupee ne depasse plus la capacite. L'entree la plus recente
+/// est toujours conservee.
+void TessellationCache::evict()
+{
+	while (memory_ > capacity_ && entries_.size() > 1) {
+		auto &last = entries_.back();
+		memory_ -= footprint(last.second);
+		index_.erase(last.first);
+		entries_.pop_back();
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "common.h"
+#include "flatten.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+namespace nealrame
+{
+class Bezier;
+
+/// Cache LRU de tessellations.
+///
+/// Les lignes brisees sont exprimees relativement au point de depart de la
+/// courbe (Bezier::p1()); la cle ne contient que la position des autres
+/// points de controle relativement a celui-ci, si bien qu'une courbe
+/// translatee retrouve la tessellation deja calculee. Le dessin se fait en
+/// decalant la ligne brisee de p1().
+class TessellationCache {
+public:
+	typedef std::shared_ptr<const Polyline> Entry;
+
+public:
+	/// Construit un cache occupant au plus capacity octets.
+	explicit TessellationCache(std::size_t capacity = 4 << 20);
+
+	/// Retourne la tessellation de la courbe pour la tolerance donnee. Les
+	/// courbes transformees l'etant par leurs points de controle (voir
+	/// Transform), la cle suffit a distinguer les echelles.
+	Entry get(const Bezier &, real tolerance);
+
+	/// Calcule, sans passer par le cache, la tessellation de la courbe
+	/// relativement a son point de depart.
+	static Entry tessellate(const Bezier &, real tolerance);
+
+	std::size_t size() const;
+	std::size_t memory() const;
+	std::size_t capacity() const;
+	void setCapacity(std::size_t);
+
+	unsigned long hits() const;
+	unsigned long misses() const;
+
+	void clear();
+
+private:
+	struct Key {
+		real coordinates[6];
+		real tolerance;
+
+		bool operator==(const Key &) const;
+	};
+
+	struct KeyHash {
+		std::size_t operator()(const Key &) const;
+	};
+
+	typedef std::list<std::pair<Key, Entry>> List;
+
+	static std::size_t footprint(const Entry &);
+	void evict();
+
+private:
+	List entries_;
+	std::unordered_map<Key, List::iterator, KeyHash> index_;
+	std::size_t capacity_;
+	std::size_t memory_;
+	unsigned long hits_;
+	unsigned long misses_;
+};
+}
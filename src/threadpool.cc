@@ -0,0 +1,174 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace nealrame;
+
+namespace
+{
+struct Queue {
+	std::mutex mutex;
+	std::deque<std::size_t> items;
+};
+}
+
+struct ThreadPool::Impl {
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	unsigned long generation = 0;
+	bool stop = false;
+
+	const Task *task = nullptr;
+	std::atomic<std::size_t> remaining{0};
+
+	bool pop(unsigned int worker, std::size_t &item);
+	bool steal(unsigned int worker, std::size_t &item);
+	void drain(unsigned int worker);
+	void run(unsigned int worker);
+};
+
+/// Le thread prend ses taches par la fin de sa file...
+bool ThreadPool::Impl::pop(unsigned int worker, std::size_t &item)
+{
+	auto &queue = *queues[worker];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.items.empty()) {
+		return false;
+	}
+	item = queue.items.back();
+	queue.items.pop_back();
+	return true;
+}
+
+/// ... et les vole par le debut de celles des autres.
+bool ThreadPool::Impl::steal(unsigned int worker, std::size_t &item)
+{
+	auto count = unsigned(queues.size());
+
+	for (unsigned int i = 1; i < count; ++i) {
+		auto &queue = *queues[(worker + i)%count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (! queue.items.empty()) {
+			item = queue.items.front();
+			queue.items.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Execute des taches tant qu'il en reste a prendre. La tache courante
+/// reste valide tant qu'un element pris n'est pas termine: parallelFor()
+/// attend que remaining soit nul avant de retourner.
+void ThreadPool::Impl::drain(unsigned int worker)
+{
+	std::size_t item;
+
+	while (pop(worker, item) || steal(worker, item)) {
+		(*task)(item, worker);
+		if (--remaining == 0) {
+			std::lock_guard<std::mutex> lock(mutex);
+			done.notify_all();
+		}
+	}
+}
+
+void ThreadPool::Impl::run(unsigned int worker)
+{
+	unsigned long seen = 0;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]{ return stop || generation != seen; });
+			if (stop) return;
+			seen = generation;
+		}
+		drain(worker);
+	}
+}
+
+ThreadPool::ThreadPool(unsigned int threads) :
+	d_(new Impl)
+{
+	if (threads == 0) {
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	for (unsigned int i = 0; i < threads; ++i) {
+		d_->queues.emplace_back(new Queue);
+	}
+
+	// La file 0 est celle du thread appelant.
+	for (unsigned int i = 1; i < threads; ++i) {
+		d_->threads.emplace_back(&Impl::run, d_.get(), i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(d_->mutex);
+		d_->stop = true;
+	}
+	d_->wake.notify_all();
+
+	for (auto &thread: d_->threads) {
+		thread.join();
+	}
+}
+
+unsigned int ThreadPool::size() const
+{
+	return unsigned(d_->queues.size());
+}
+
+void ThreadPool::parallelFor(std::size_t count, const Task &task)
+{
+	if (count == 0) return;
+
+	if (d_->threads.empty()) {
+		for (std::size_t i = 0; i < count; ++i) {
+			task(i, 0);
+		}
+		return;
+	}
+
+	d_->task = &task;
+	d_->remaining = count;
+
+	// Les elements sont repartis par blocs contigus entre les files.
+	auto queues = d_->queues.size();
+	for (std::size_t q = 0; q < queues; ++q) {
+		auto &queue = *d_->queues[q];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		for (auto i = q*count/queues, end = (q + 1)*count/queues; i < end; ++i) {
+			queue.items.push_front(i);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(d_->mutex);
+		++d_->generation;
+	}
+	d_->wake.notify_all();
+
+	d_->drain(0);
+
+	std::unique_lock<std::mutex> lock(d_->mutex);
+	d_->done.wait(lock, [&]{ return d_->remaining == 0; });
+	d_->task = nullptr;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace nealrame
+{
+/// Groupe de threads a vol de taches: chaque thread a sa propre file de
+/// taches et, lorsqu'elle est vide, prend des taches dans celles des
+/// autres. Le thread appelant participe au travail.
+class ThreadPool {
+	PIMPL;
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool & operator=(const ThreadPool &) = delete;
+
+public:
+	/// Tache recevant l'indice de l'element a traiter et celui du thread
+	/// qui l'execute (entre 0 et size() exclus).
+	typedef std::function<void(std::size_t item, unsigned int worker)> Task;
+
+public:
+	/// Construit un groupe de threads threads au total, thread appelant
+	/// compris (0 pour le nombre de coeurs disponibles).
+	explicit ThreadPool(unsigned int threads = 0);
+	virtual ~ThreadPool();
+
+	/// Nombre de threads, thread appelant compris.
+	unsigned int size() const;
+
+	/// Execute task pour chaque element de 0 a count exclus et retourne
+	/// lorsque toutes les executions sont terminees.
+	void parallelFor(std::size_t count, const Task &task);
+};
+}
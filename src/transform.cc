@@ -0,0 +1,125 @@
+#include "transform.h"
+
+#include "bezier.h"
+#include "error.h"
+#include "rect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+using namespace nealrame;
+
+static_assert(std::is_trivially_copyable<Transform>::value, "Transform must stay trivially copyable");
+
+Transform::Transform() :
+	a_(1), b_(0), c_(0), d_(1), e_(0), f_(0)
+{ }
+
+Transform::Transform(real a, real b, real c, real d, real e, real f) :
+	a_(a), b_(b), c_(c), d_(d), e_(e), f_(f)
+{ }
+
+Transform Transform::translation(real x, real y)
+{
+	return Transform(1, 0, 0, 1, x, y);
+}
+
+Transform Transform::translation(const Point &p)
+{
+	return translation(p.x, p.y);
+}
+
+Transform Transform::scaling(real sx, real sy)
+{
+	return Transform(sx, 0, 0, sy, 0, 0);
+}
+
+Transform Transform::scaling(real s)
+{
+	return scaling(s, s);
+}
+
+Transform Transform::rotation(real angle)
+{
+	auto cos = std::cos(angle), sin = std::sin(angle);
+	return Transform(cos, sin, -sin, cos, 0, 0);
+}
+
+Transform Transform::operator*(const Transform &rhs) const
+{
+	return Transform(
+		a_*rhs.a_ + c_*rhs.b_,
+		b_*rhs.a_ + d_*rhs.b_,
+		a_*rhs.c_ + c_*rhs.d_,
+		b_*rhs.c_ + d_*rhs.d_,
+		a_*rhs.e_ + c_*rhs.f_ + e_,
+		b_*rhs.e_ + d_*rhs.f_ + f_
+	);
+}
+
+Bezier Transform::operator()(const Bezier &curve) const
+{
+	auto &t = *this;
+	return Bezier(t(curve.p1()), t(curve.ctrl1()), t(curve.ctrl2()), t(curve.p2()));
+}
+
+Rect Transform::operator()(const Rect &rect) const
+{
+	auto &t = *this;
+	const Point corners[] = {
+		t(rect.topLeft()), t(rect.topRight()), t(rect.bottomRight()), t(rect.bottomLeft())
+	};
+	auto min = corners[0], max = corners[0];
+	for (auto &p: corners) {
+		min = {std::min(min.x, p.x), std::min(min.y, p.y)};
+		max = {std::max(max.x, p.x), std::max(max.y, p.y)};
+	}
+	return Rect(min, max);
+}
+
+Transform Transform::inverted() const
+{
+	auto det = determinant();
+	if (det == 0 || ! std::isfinite(det)) {
+		throw Error("Transform: not invertible");
+	}
+	auto a = d_/det, b = -b_/det, c = -c_/det, d = a_/det;
+	return Transform(a, b, c, d, -(a*e_ + c*f_), -(b*e_ + d*f_));
+}
+
+real Transform::determinant() const
+{
+	return a_*d_ - b_*c_;
+}
+
+/// La plus grande valeur singuliere de la partie lineaire M est la racine
+/// de la plus grande valeur propre de M^T*M.
+real Transform::scale() const
+{
+	auto p = SQUARE(a_) + SQUARE(b_), q = SQUARE(c_) + SQUARE(d_);
+	auto r = a_*c_ + b_*d_;
+	auto half = (p + q)/2;
+	return std::sqrt(half + std::sqrt(SQUARE(p - q)/4 + SQUARE(r)));
+}
+
+bool Transform::isIdentity() const
+{
+	return isTranslation() && e_ == 0 && f_ == 0;
+}
+
+bool Transform::isTranslation() const
+{
+	return a_ == 1 && b_ == 0 && c_ == 0 && d_ == 1;
+}
+
+bool Transform::isAxisAligned() const
+{
+	return b_ == 0 && c_ == 0;
+}
+
+bool Transform::operator==(const Transform &rhs) const
+{
+	return a_ == rhs.a_ && b_ == rhs.b_ && c_ == rhs.c_ && d_ == rhs.d_
+		&& e_ == rhs.e_ && f_ == rhs.f_;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common.h"
+#include "point.h"
+
+namespace nealrame
+{
+class Bezier;
+class Rect;
+
+/// Transformation affine du plan:
+///     x' = a*x + c*y + e
+///     y' = b*x + d*y + f
+/// Les courbes de Bezier sont invariantes par transformation affine: l'image
+/// d'une courbe est la courbe des images de ses points de controle. Une
+/// courbe est donc transformee en quatre points, quel que soit le nombre
+/// d'echantillons necessaires a son trace.
+class Transform {
+public:
+	/// Identite.
+	Transform();
+	Transform(real a, real b, real c, real d, real e, real f);
+
+	static Transform translation(real x, real y);
+	static Transform translation(const Point &);
+	static Transform scaling(real sx, real sy);
+	static Transform scaling(real s);
+
+	/// Rotation d'angle angle (en radians) autour de l'origine.
+	static Transform rotation(real angle);
+
+public:
+	/// Composee des transformations: (t1*t2)(p) = t1(t2(p)).
+	Transform operator*(const Transform &) const;
+
+	Point operator()(const Point &p) const
+	{ return {a_*p.x + c_*p.y + e_, b_*p.x + d_*p.y + f_}; }
+
+	/// Applique la partie lineaire de la transformation au vecteur v.
+	Point vector(const Point &v) const
+	{ return {a_*v.x + c_*v.y, b_*v.x + d_*v.y}; }
+
+	/// Retourne la courbe transformee (seuls ses points de controle le
+	/// sont).
+	Bezier operator()(const Bezier &) const;
+
+	/// Retourne la boite englobant l'image du rectangle.
+	Rect operator()(const Rect &) const;
+
+	/// Retourne la transformation inverse. Leve une Error si la
+	/// transformation n'est pas inversible.
+	Transform inverted() const;
+
+	real determinant() const;
+
+	/// Retourne le plus grand facteur d'agrandissement d'une longueur: une
+	/// distance d en entree vaut au plus d*scale() apres transformation.
+	real scale() const;
+
+	bool isIdentity() const;
+
+	/// Indique si la transformation est une simple translation.
+	bool isTranslation() const;
+
+	/// Indique si la transformation conserve les rectangles dont les cotes
+	/// sont paralleles aux axes (ni rotation, ni cisaillement).
+	bool isAxisAligned() const;
+
+	/// Partie translation de la transformation.
+	Point offset() const
+	{ return {e_, f_}; }
+
+	bool operator==(const Transform &) const;
+	bool operator!=(const Transform &rhs) const
+	{ return ! (*this == rhs); }
+
+private:
+	real a_, b_, c_, d_, e_, f_;
+};
+}
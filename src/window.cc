@@ -25,6 +25,43 @@ struct Window::Impl {
 	std::string title;
 	std::unique_ptr<SDL_Window, std::function<void(SDL_Window *)>> window;
 	HandlersMap eventHandlers;
+
+	void dispatch(const SDL_Event &ev)
+	{
+		for (auto handler: *(eventHandlers.begin() + ev.type)) {
+			handler(ev);
+		}
+	}
+
+	/// Traite ev puis les evenements en attente, en fusionnant les
+	/// deplacements de la souris consecutifs. Les autres evenements sont
+	/// transmis dans leur ordre d'arrivee.
+	void process(SDL_Event ev)
+	{
+		SDL_Event motion;
+		bool pending = false;
+
+		do {
+			if (ev.type == SDL_MOUSEMOTION) {
+				if (pending) {
+					ev.motion.xrel += motion.motion.xrel;
+					ev.motion.yrel += motion.motion.yrel;
+				}
+				motion = ev;
+				pending = true;
+				continue;
+			}
+			if (pending) {
+				dispatch(motion);
+				pending = false;
+			}
+			dispatch(ev);
+		} while (SDL_PollEvent(&ev));
+
+		if (pending) {
+			dispatch(motion);
+		}
+	}
 };
 
 Window::Window(const std::string &title, uint16_t width, uint16_t height) :
@@ -72,11 +109,20 @@ void Window::pollEvent()
 {
 	SDL_Event ev;
 
-	while (SDL_PollEvent(&ev)) {
-		for (auto handler: *(d_->eventHandlers.begin() + ev.type)) {
-			handler(ev);
-		}
+	if (SDL_PollEvent(&ev)) {
+		d_->process(ev);
+	}
+}
+
+bool Window::waitEvent(int timeout)
+{
+	SDL_Event ev;
+
+	if (timeout < 0 ? ! SDL_WaitEvent(&ev) : ! SDL_WaitEventTimeout(&ev, timeout)) {
+		return false;
 	}
+	d_->process(ev);
+	return true;
 }
 
 void * Window::get()
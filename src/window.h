@@ -29,8 +29,19 @@ public:
 
 public:
 	void on(Event, std::function<void(const EventData &)>);
+
+	/// Traite les evenements en attente, sans bloquer.
 	void pollEvent();
 
+	/// Attend un evenement au plus timeout millisecondes (indefiniment si
+	/// timeout est negatif), puis traite tous les evenements en attente.
+	/// Retourne false si aucun evenement n'est arrive dans le delai.
+	///
+	/// Comme pour pollEvent(), une rafale de SDL_MOUSEMOTION consecutifs
+	/// n'est transmise aux gestionnaires qu'une fois: le dernier
+	/// deplacement, dont xrel et yrel cumulent ceux de la rafale.
+	bool waitEvent(int timeout = -1);
+
 public:
 	void * get();
 };